@@ -195,6 +195,8 @@ static const GncGUID * gncEntryGetGUID(GncEntry *x);
 %include <gnc-lot.h>
 
 //core business includes
+%ignore gncOwnerGetOpenLots;
+%ignore gncOwnerFindOpenLots;
 %include <gncOwner.h>
 %include <gncCustomer.h>
 %include <gncCustomerP.h>
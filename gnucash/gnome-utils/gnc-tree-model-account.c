@@ -101,11 +101,29 @@ typedef struct GncTreeModelAccountPrivate
 
     GHashTable *account_values_hash;
 
+    /* Balance values are computed in an idle handler. Until that happened,
+     * the last known value of a cell (if any) is kept here so it can be
+     * displayed instead. */
+    GHashTable *stale_values_hash;
+    GHashTable *pending_values_hash;
+    guint pending_idle_id;
+
 } GncTreeModelAccountPrivate;
 
 #define GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(o)  \
    ((GncTreeModelAccountPrivate*)g_type_instance_get_private ((GTypeInstance*)o, GNC_TYPE_TREE_MODEL_ACCOUNT))
 
+/** A balance cell waiting to be computed. The account is referenced by
+ *  guid as it may be deleted before the value gets computed. */
+typedef struct
+{
+    GncGUID guid;
+    gint column;
+} PendingValue;
+
+/** Maximum time (in seconds) spent computing balances in one idle run */
+#define PENDING_VALUES_TIME_SLICE 0.02
+
 
 /************************************************************/
 /*           Account Tree Model - Misc Functions            */
@@ -133,6 +151,7 @@ gnc_tree_model_account_update_color (gpointer gsettings, gchar *key, gpointer us
     g_hash_table_destroy (priv->account_values_hash);
     priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                        g_free, g_free);
+    g_hash_table_remove_all (priv->stale_values_hash);
 
     use_red = gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED);
 
@@ -200,6 +219,11 @@ gnc_tree_model_account_init (GncTreeModelAccount *model)
     // create the account values cache hash
     priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                        g_free, g_free);
+    priv->stale_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                     g_free, g_free);
+    priv->pending_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                       g_free, g_free);
+    priv->pending_idle_id = 0;
 
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                            gnc_tree_model_account_update_color,
@@ -252,8 +276,16 @@ gnc_tree_model_account_dispose (GObject *object)
     if (priv->negative_color)
         g_free (priv->negative_color);
 
+    if (priv->pending_idle_id)
+    {
+        g_source_remove (priv->pending_idle_id);
+        priv->pending_idle_id = 0;
+    }
+
     // destroy the cached account values
     g_hash_table_destroy (priv->account_values_hash);
+    g_hash_table_destroy (priv->stale_values_hash);
+    g_hash_table_destroy (priv->pending_values_hash);
 
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED,
                                  gnc_tree_model_account_update_color,
@@ -584,6 +616,45 @@ gnc_tree_model_account_compute_period_balance (GncTreeModelAccount *model,
     return g_strdup(xaccPrintAmount (b3, gnc_account_print_info (acct, TRUE)));
 }
 
+/** Returns TRUE for the columns whose value is derived from the account
+ *  balances. These can be expensive to compute, so they are computed
+ *  from an idle handler rather than when the view asks for them.
+ *
+ *  @internal
+ */
+static gboolean
+gnc_tree_model_account_column_is_deferred (gint column)
+{
+    switch (column)
+    {
+    case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT:
+    case GNC_TREE_MODEL_ACCOUNT_COL_PRESENT_REPORT:
+    case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_PRESENT:
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE:
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_REPORT:
+    case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE:
+    case GNC_TREE_MODEL_ACCOUNT_COL_BALANCE_PERIOD:
+    case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_BALANCE_PERIOD:
+    case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED:
+    case GNC_TREE_MODEL_ACCOUNT_COL_CLEARED_REPORT:
+    case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_CLEARED:
+    case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED:
+    case GNC_TREE_MODEL_ACCOUNT_COL_RECONCILED_REPORT:
+    case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_RECONCILED:
+    case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN:
+    case GNC_TREE_MODEL_ACCOUNT_COL_FUTURE_MIN_REPORT:
+    case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_FUTURE_MIN:
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL:
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_REPORT:
+    case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL:
+    case GNC_TREE_MODEL_ACCOUNT_COL_TOTAL_PERIOD:
+    case GNC_TREE_MODEL_ACCOUNT_COL_COLOR_TOTAL_PERIOD:
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
 static gboolean
 row_changed_foreach_func (GtkTreeModel *model, GtkTreePath  *path,
                           GtkTreeIter  *iter, gpointer user_data)
@@ -599,8 +670,9 @@ gnc_tree_model_account_clear_cache (GncTreeModelAccount *model)
     {
         GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
 
-        // destroy the cached account values and recreate
-        g_hash_table_destroy (priv->account_values_hash);
+        // keep the cached account values as last known values and recreate
+        g_hash_table_destroy (priv->stale_values_hash);
+        priv->stale_values_hash = priv->account_values_hash;
         priv->account_values_hash = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                            g_free, g_free);
 
@@ -609,7 +681,8 @@ gnc_tree_model_account_clear_cache (GncTreeModelAccount *model)
 }
 
 static void
-clear_account_cached_values (GncTreeModelAccount *model, GHashTable *hash, Account *account)
+clear_account_cached_values (GncTreeModelAccount *model, GHashTable *hash,
+                             GHashTable *stale_hash, Account *account)
 {
     GtkTreeIter iter;
     gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
@@ -632,6 +705,12 @@ clear_account_cached_values (GncTreeModelAccount *model, GHashTable *hash, Accou
     for (gint col = 0; col <= GNC_TREE_MODEL_ACCOUNT_NUM_COLUMNS; col++)
     {
         gchar *key = g_strdup_printf ("%s,%d", acct_guid_str, col);
+        gpointer value;
+
+        // balances are recomputed in the background, keep the old one meanwhile
+        if (gnc_tree_model_account_column_is_deferred (col) &&
+            g_hash_table_lookup_extended (hash, key, NULL, &value))
+            g_hash_table_insert (stale_hash, g_strdup (key), g_strdup (value));
 
         g_hash_table_remove (hash, key);
         g_free (key);
@@ -648,13 +727,15 @@ gnc_tree_model_account_clear_cached_values (GncTreeModelAccount *model, Account
     if ((!priv->account_values_hash) || (!account))
         return;
 
-    clear_account_cached_values (model, priv->account_values_hash, account);
+    clear_account_cached_values (model, priv->account_values_hash,
+                                 priv->stale_values_hash, account);
     parent = gnc_account_get_parent (account);
 
     // clear also all parent accounts, this will update any balances/totals
     while (parent)
     {
-        clear_account_cached_values (model, priv->account_values_hash, parent);
+        clear_account_cached_values (model, priv->account_values_hash,
+                                     priv->stale_values_hash, parent);
         parent = gnc_account_get_parent (parent);
     }
 }
@@ -709,40 +790,22 @@ gnc_tree_model_account_set_cached_value (GncTreeModelAccount *model, Account *ac
     }
 }
 
+/** Compute the value of one cell of the account tree.
+ *
+ *  @internal
+ */
 static void
-gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
-                                  GtkTreeIter *iter,
-                                  int column,
-                                  GValue *value)
+gnc_tree_model_account_compute_value (GncTreeModelAccount *model,
+                                      Account *account,
+                                      int column,
+                                      GValue *value)
 {
-    GncTreeModelAccount *model = GNC_TREE_MODEL_ACCOUNT(tree_model);
-    GncTreeModelAccountPrivate *priv;
-    Account *account;
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
     gboolean negative; /* used to set "deficit style" also known as red numbers */
     gchar *string;
-    gchar *cached_string = NULL;
 
     time64 last_date;
 
-    g_return_if_fail (GNC_IS_TREE_MODEL_ACCOUNT(model));
-    g_return_if_fail (iter != NULL);
-    g_return_if_fail (iter->user_data != NULL);
-    g_return_if_fail (iter->stamp == model->stamp);
-
-    ENTER("model %p, iter %s, col %d", tree_model,
-          iter_to_string (iter), column);
-
-    account = (Account *) iter->user_data;
-    priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
-
-    // lets see if the value is in the cache
-    if (gnc_tree_model_account_get_cached_value (model, account, column, &cached_string))
-    {
-        g_value_init (value, G_TYPE_STRING);
-        g_value_take_string (value, cached_string);
-        return;
-    }
-
     switch (column)
     {
     case GNC_TREE_MODEL_ACCOUNT_COL_NAME:
@@ -953,6 +1016,158 @@ gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
         g_assert_not_reached ();
         break;
     }
+}
+
+/** Compute the values of the balance cells that were requested by the
+ *  view since the last run. This runs from an idle handler so the values
+ *  get filled in without blocking the view while scrolling. It stops
+ *  after a short while and continues on the next idle run if there's
+ *  more work left.
+ *
+ *  @internal
+ */
+static gboolean
+gnc_tree_model_account_compute_pending_values (gpointer user_data)
+{
+    GncTreeModelAccount *model = GNC_TREE_MODEL_ACCOUNT(user_data);
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    GTimer *timer = g_timer_new ();
+    GHashTableIter hash_iter;
+    gpointer key, pending;
+    GList *changed = NULL, *node;
+
+    ENTER("model %p, %d values pending", model,
+          g_hash_table_size (priv->pending_values_hash));
+
+    g_hash_table_iter_init (&hash_iter, priv->pending_values_hash);
+    while (g_hash_table_iter_next (&hash_iter, &key, &pending))
+    {
+        PendingValue *pv = pending;
+        Account *account = xaccAccountLookup (&pv->guid, priv->book);
+        GValue value = G_VALUE_INIT;
+
+        /* The account may have gone away in the meantime */
+        if (account && gnc_account_get_root (account) == priv->root)
+        {
+            gnc_tree_model_account_compute_value (model, account, pv->column, &value);
+            gnc_tree_model_account_set_cached_value (model, account, pv->column, &value);
+            g_value_unset (&value);
+
+            /* Several columns of one row are usually queued together,
+             * only tell the view once */
+            if (!g_list_find (changed, account))
+                changed = g_list_prepend (changed, account);
+        }
+        g_hash_table_remove (priv->stale_values_hash, key);
+        g_hash_table_iter_remove (&hash_iter);
+
+        if (g_timer_elapsed (timer, NULL) > PENDING_VALUES_TIME_SLICE)
+            break;
+    }
+    g_timer_destroy (timer);
+
+    /* Only notify the view now, it may ask for more values in response */
+    for (node = changed; node; node = g_list_next (node))
+    {
+        GtkTreeIter iter;
+        if (gnc_tree_model_account_get_iter_from_account (model, node->data, &iter))
+        {
+            GtkTreePath *path = gtk_tree_model_get_path (GTK_TREE_MODEL(model), &iter);
+            gtk_tree_model_row_changed (GTK_TREE_MODEL(model), path, &iter);
+            gtk_tree_path_free (path);
+        }
+    }
+    g_list_free (changed);
+
+    if (g_hash_table_size (priv->pending_values_hash) > 0)
+    {
+        LEAVE("%d values left", g_hash_table_size (priv->pending_values_hash));
+        return G_SOURCE_CONTINUE;
+    }
+
+    priv->pending_idle_id = 0;
+    LEAVE("done");
+    return G_SOURCE_REMOVE;
+}
+
+/** Fill in the last known value of a balance cell and queue it for
+ *  computation in the idle handler.
+ *
+ *  @internal
+ */
+static void
+gnc_tree_model_account_defer_value (GncTreeModelAccount *model, Account *account,
+                                    gint column, GValue *value)
+{
+    GncTreeModelAccountPrivate *priv = GNC_TREE_MODEL_ACCOUNT_GET_PRIVATE(model);
+    gchar acct_guid_str[GUID_ENCODING_LENGTH + 1];
+    gchar *key;
+    gpointer stale_value;
+
+    guid_to_string_buff (xaccAccountGetGUID (account), acct_guid_str);
+    key = g_strdup_printf ("%s,%d", acct_guid_str, column);
+
+    g_value_init (value, G_TYPE_STRING);
+    if (g_hash_table_lookup_extended (priv->stale_values_hash, key, NULL, &stale_value))
+        g_value_set_string (value, stale_value);
+
+    if (g_hash_table_contains (priv->pending_values_hash, key))
+    {
+        g_free (key);
+        return;
+    }
+
+    {
+        PendingValue *pv = g_new0 (PendingValue, 1);
+        pv->guid = *xaccAccountGetGUID (account);
+        pv->column = column;
+        g_hash_table_insert (priv->pending_values_hash, key, pv);
+    }
+
+    if (!priv->pending_idle_id)
+        priv->pending_idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                                 gnc_tree_model_account_compute_pending_values,
+                                                 model, NULL);
+}
+
+static void
+gnc_tree_model_account_get_value (GtkTreeModel *tree_model,
+                                  GtkTreeIter *iter,
+                                  int column,
+                                  GValue *value)
+{
+    GncTreeModelAccount *model = GNC_TREE_MODEL_ACCOUNT(tree_model);
+    Account *account;
+    gchar *cached_string = NULL;
+
+    g_return_if_fail (GNC_IS_TREE_MODEL_ACCOUNT(model));
+    g_return_if_fail (iter != NULL);
+    g_return_if_fail (iter->user_data != NULL);
+    g_return_if_fail (iter->stamp == model->stamp);
+
+    ENTER("model %p, iter %s, col %d", tree_model,
+          iter_to_string (iter), column);
+
+    account = (Account *) iter->user_data;
+
+    // lets see if the value is in the cache
+    if (gnc_tree_model_account_get_cached_value (model, account, column, &cached_string))
+    {
+        g_value_init (value, G_TYPE_STRING);
+        g_value_take_string (value, cached_string);
+        LEAVE("cached");
+        return;
+    }
+
+    // balances are computed later on, return the last known value for now
+    if (gnc_tree_model_account_column_is_deferred (column))
+    {
+        gnc_tree_model_account_defer_value (model, account, column, value);
+        LEAVE("deferred");
+        return;
+    }
+
+    gnc_tree_model_account_compute_value (model, account, column, value);
 
     // save the value to the account values cache
     gnc_tree_model_account_set_cached_value (model, account, column, value);
@@ -188,6 +188,26 @@ gnc_plugin_page_sx_list_new (void)
 }
 
 
+/**
+ * Keep the instances shown by the page a year ahead of today. The
+ * page can stay open for days, so the range is moved forward whenever
+ * the page is shown or refreshed; only the new instances get created.
+ */
+static void
+gppsl_update_instances_range (GncPluginPageSxList *page)
+{
+    GncPluginPageSxListPrivate *priv = GNC_PLUGIN_PAGE_SX_LIST_GET_PRIVATE(page);
+    GDate end;
+
+    if (!priv->instances)
+        return;
+
+    g_date_clear(&end, 1);
+    gnc_gdate_set_today (&end);
+    g_date_add_years(&end, 1);
+    gnc_sx_instance_model_set_range_end(priv->instances, &end);
+}
+
 /**
  * Whenever the current page is changed, if a sx page is
  * the current page, set focus on the tree view.
@@ -200,6 +220,8 @@ gnc_plugin_page_sx_list_focus_widget (GncPluginPage *sx_plugin_page)
         GncPluginPageSxListPrivate *priv = GNC_PLUGIN_PAGE_SX_LIST_GET_PRIVATE(sx_plugin_page);
         GtkTreeView *tree_view = priv->tree_view;
 
+        gppsl_update_instances_range (GNC_PLUGIN_PAGE_SX_LIST(sx_plugin_page));
+
         if (GTK_IS_TREE_VIEW(tree_view))
         {
             if (!gtk_widget_is_focus (GTK_WIDGET(tree_view)))
@@ -320,6 +342,7 @@ gnc_plugin_page_sx_list_refresh_cb (GHashTable *changes, gpointer user_data)
         return;
 
     priv = GNC_PLUGIN_PAGE_SX_LIST_GET_PRIVATE(page);
+    gppsl_update_instances_range (page);
     gtk_widget_queue_draw(priv->widget);
 }
 
@@ -656,6 +679,7 @@ gnc_plugin_page_sx_list_cmd_refresh (GtkAction *action, GncPluginPageSxList *pag
     g_return_if_fail (GNC_IS_PLUGIN_PAGE_SX_LIST(page));
 
     priv = GNC_PLUGIN_PAGE_SX_LIST_GET_PRIVATE(page);
+    gppsl_update_instances_range (page);
     gtk_widget_queue_draw (priv->widget);
 }
 
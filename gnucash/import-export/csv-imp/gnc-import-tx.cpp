@@ -30,6 +30,8 @@ extern "C" {
 #endif
 
 #include <glib/gi18n.h>
+
+#include "gnc-ui-util.h"
 }
 
 #include <algorithm>
@@ -37,6 +39,7 @@ extern "C" {
 #include <iostream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -772,24 +775,32 @@ void GncTxImport::update_pre_trans_props (uint32_t row, uint32_t col, GncTransPr
 
     /* Store the result */
     std::get<PL_PRETRANS>(m_parsed_lines[row]) = trans_props;
+}
 
+/* A helper function intended to be called only from set_column_type
+ * It has to be called for each row in sequence after the transaction
+ * properties of that row have been updated, as it depends on the
+ * transaction started by the previous lines. */
+void GncTxImport::update_multi_split_parent (uint32_t row)
+{
     /* For multi-split input data, we need to check whether this line is part of
      * a transaction that has already been started by a previous line. */
-    if (m_settings.m_multi_split)
+    if (!m_settings.m_multi_split)
+        return;
+
+    auto trans_props = std::get<PL_PRETRANS>(m_parsed_lines[row]);
+    if (trans_props->is_part_of(m_parent))
     {
-        if (trans_props->is_part_of(m_parent))
-        {
-            /* This line is part of an already started transaction
-             * continue with that one instead to make sure the split from this line
-             * gets added to the proper transaction */
-            std::get<PL_PRETRANS>(m_parsed_lines[row]) = m_parent;
-        }
-        else
-        {
-            /* This line starts a new transaction, set it as parent for
-             * subsequent lines. */
-            m_parent = trans_props;
-        }
+        /* This line is part of an already started transaction
+         * continue with that one instead to make sure the split from this line
+         * gets added to the proper transaction */
+        std::get<PL_PRETRANS>(m_parsed_lines[row]) = m_parent;
+    }
+    else
+    {
+        /* This line starts a new transaction, set it as parent for
+         * subsequent lines. */
+        m_parent = trans_props;
     }
 }
 
@@ -838,6 +849,29 @@ void GncTxImport::update_pre_split_props (uint32_t row, uint32_t col, GncTransPr
     }
 }
 
+/* Minimum number of lines worth handing over to a separate thread
+ * when converting a column. Below that the thread startup cost
+ * outweighs the gain. */
+static const uint32_t min_lines_per_thread = 500;
+
+/* Returns true if the conversion of a cell into property prop_type can
+ * safely run outside of the main thread. Properties that look up
+ * accounts or commodities in the book or that use the (global) expression
+ * parser can't. */
+static bool
+parse_in_thread_ok (GncTransPropType prop_type)
+{
+    switch (prop_type)
+    {
+        case GncTransPropType::COMMODITY:
+        case GncTransPropType::ACCOUNT:
+        case GncTransPropType::TACCOUNT:
+        case GncTransPropType::PRICE:
+            return false;
+        default:
+            return true;
+    }
+}
 
 void
 GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool force)
@@ -862,42 +896,88 @@ GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool for
     if (type == GncTransPropType::ACCOUNT)
         base_account (nullptr);
 
-    /* Update the preparsed data */
-    m_parent = nullptr;
-    for (auto parsed_lines_it = m_parsed_lines.begin();
-            parsed_lines_it != m_parsed_lines.end();
-            ++parsed_lines_it)
+    /* Reset date and currency formats for each trans/split props object
+     * to ensure column updates use the most recent one.
+     * In multi-split mode consecutive lines share their trans props
+     * object, so this is done before the lines are spread over threads.
+     */
+    for (auto& parsed_line : m_parsed_lines)
     {
-        /* Reset date and currency formats for each trans/split props object
-         * to ensure column updates use the most recent one
-         */
-        std::get<PL_PRETRANS>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PRESPLIT>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PRESPLIT>(*parsed_lines_it)->set_currency_format (m_settings.m_currency_format);
-
-        uint32_t row = parsed_lines_it - m_parsed_lines.begin();
+        std::get<PL_PRETRANS>(parsed_line)->set_date_format (m_settings.m_date_format);
+        std::get<PL_PRESPLIT>(parsed_line)->set_date_format (m_settings.m_date_format);
+        std::get<PL_PRESPLIT>(parsed_line)->set_currency_format (m_settings.m_currency_format);
+    }
 
-        /* If the column type actually changed, first reset the property
-         * represented by the old column type
-         */
-        if (old_type != type)
+    /* Update the preparsed data
+     * This happens in two passes. The first one converts the cell values
+     * of the affected column into transaction and split properties.
+     * Each line is independent of the others in this pass so it is spread
+     * over several worker threads if the column type permits it.
+     * The second pass links multi-split lines to their parent transaction
+     * and collects the errors. It depends on the previous lines so it
+     * runs sequentially.
+     */
+    auto update_rows = [this, position, type, old_type](uint32_t first, uint32_t last)
+    {
+        for (auto row = first; row < last; row++)
         {
-            auto old_col = std::get<PL_INPUT>(*parsed_lines_it).size(); // Deliberately out of bounds to trigger a reset!
-            if ((old_type > GncTransPropType::NONE)
-                    && (old_type <= GncTransPropType::TRANS_PROPS))
-                update_pre_trans_props (row, old_col, old_type);
-            else if ((old_type > GncTransPropType::TRANS_PROPS)
-                    && (old_type <= GncTransPropType::SPLIT_PROPS))
-                update_pre_split_props (row, old_col, old_type);
+            auto& parsed_line = m_parsed_lines[row];
+
+            /* If the column type actually changed, first reset the property
+             * represented by the old column type
+             */
+            if (old_type != type)
+            {
+                auto old_col = std::get<PL_INPUT>(parsed_line).size(); // Deliberately out of bounds to trigger a reset!
+                if ((old_type > GncTransPropType::NONE)
+                        && (old_type <= GncTransPropType::TRANS_PROPS))
+                    update_pre_trans_props (row, old_col, old_type);
+                else if ((old_type > GncTransPropType::TRANS_PROPS)
+                        && (old_type <= GncTransPropType::SPLIT_PROPS))
+                    update_pre_split_props (row, old_col, old_type);
+            }
+
+            /* Then set the property represented by the new column type */
+            if ((type > GncTransPropType::NONE)
+                    && (type <= GncTransPropType::TRANS_PROPS))
+                update_pre_trans_props (row, position, type);
+            else if ((type > GncTransPropType::TRANS_PROPS)
+                    && (type <= GncTransPropType::SPLIT_PROPS))
+                update_pre_split_props (row, position, type);
         }
+    };
+
+    uint32_t num_lines = m_parsed_lines.size();
+    auto num_threads = std::min (std::thread::hardware_concurrency(),
+                                 num_lines / min_lines_per_thread);
+    if (num_threads > 1 && parse_in_thread_ok (type) &&
+        parse_in_thread_ok (old_type))
+    {
+        /* Make sure the locale information is cached before the worker threads
+         * start using it, its initialization isn't thread safe. */
+        gnc_localeconv ();
+        auto workers = std::vector<std::thread>();
+        auto chunk = (num_lines + num_threads - 1) / num_threads;
+        for (uint32_t first = 0; first < num_lines; first += chunk)
+            workers.emplace_back (update_rows, first,
+                                  std::min (first + chunk, num_lines));
+        for (auto& worker : workers)
+            worker.join();
+    }
+    else
+        update_rows (0, num_lines);
 
-        /* Then set the property represented by the new column type */
-        if ((type > GncTransPropType::NONE)
-                && (type <= GncTransPropType::TRANS_PROPS))
-            update_pre_trans_props (row, position, type);
-        else if ((type > GncTransPropType::TRANS_PROPS)
-                && (type <= GncTransPropType::SPLIT_PROPS))
-            update_pre_split_props (row, position, type);
+    auto trans_col_changed = ((type > GncTransPropType::NONE)
+                && (type <= GncTransPropType::TRANS_PROPS)) ||
+            ((old_type != type) && (old_type > GncTransPropType::NONE)
+                && (old_type <= GncTransPropType::TRANS_PROPS));
+    m_parent = nullptr;
+    for (auto parsed_lines_it = m_parsed_lines.begin();
+            parsed_lines_it != m_parsed_lines.end();
+            ++parsed_lines_it)
+    {
+        if (trans_col_changed)
+            update_multi_split_parent (parsed_lines_it - m_parsed_lines.begin());
 
         /* Report errors if there are any */
         auto trans_errors = std::get<PL_PRETRANS>(*parsed_lines_it)->errors();
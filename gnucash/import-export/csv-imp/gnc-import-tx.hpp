@@ -188,6 +188,7 @@ private:
      */
     void update_pre_trans_props (uint32_t row, uint32_t col, GncTransPropType prop_type);
     void update_pre_split_props (uint32_t row, uint32_t col, GncTransPropType prop_type);
+    void update_multi_split_parent (uint32_t row);
 
     struct CsvTranImpSettings; //FIXME do we need this line
     CsvTransImpSettings m_settings;
@@ -0,0 +1,515 @@
+/********************************************************************
+ * gnc-trep-engine.cpp -- filtering and sorting for the transaction *
+ *                        report                                    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+#include <config.h>
+
+#include <glib.h>
+#include <string.h>
+
+#include "Account.h"
+#include "Query.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "gnc-date.h"
+#include "gnc-trep-engine.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+static QofLogModule log_module = "gnc.report.core";
+
+enum class SortKey
+{
+    NONE,
+    ACCOUNT_NAME,
+    ACCOUNT_CODE,
+    DATE,
+    RECONCILED_DATE,
+    RECONCILED_STATUS,
+    CORR_ACCOUNT_NAME,
+    CORR_ACCOUNT_CODE,
+    AMOUNT,
+    DESCRIPTION,
+    NUMBER,
+    T_NUMBER,
+    MEMO,
+    NOTES,
+};
+
+enum class DateGroup
+{
+    NONE,
+    DAY,
+    WEEK,
+    MONTH,
+    QUARTER,
+    YEAR,
+};
+
+struct SortKeyName
+{
+    const char *name;
+    SortKey key;
+};
+
+/* 'register-order and 'none have no split-sortvalue in trep-engine.scm,
+ * so they never reorder anything. */
+static const SortKeyName sort_key_names[] =
+{
+    { "account-name", SortKey::ACCOUNT_NAME },
+    { "account-code", SortKey::ACCOUNT_CODE },
+    { "date", SortKey::DATE },
+    { "reconciled-date", SortKey::RECONCILED_DATE },
+    { "reconciled-status", SortKey::RECONCILED_STATUS },
+    { "register-order", SortKey::NONE },
+    { "corresponding-acc-name", SortKey::CORR_ACCOUNT_NAME },
+    { "corresponding-acc-code", SortKey::CORR_ACCOUNT_CODE },
+    { "amount", SortKey::AMOUNT },
+    { "description", SortKey::DESCRIPTION },
+    { "number", SortKey::NUMBER },
+    { "t-number", SortKey::T_NUMBER },
+    { "memo", SortKey::MEMO },
+    { "notes", SortKey::NOTES },
+    { "none", SortKey::NONE },
+};
+
+struct DateGroupName
+{
+    const char *name;
+    DateGroup group;
+};
+
+static const DateGroupName date_group_names[] =
+{
+    { "none", DateGroup::NONE },
+    { "daily", DateGroup::DAY },
+    { "weekly", DateGroup::WEEK },
+    { "monthly", DateGroup::MONTH },
+    { "quarterly", DateGroup::QUARTER },
+    { "yearly", DateGroup::YEAR },
+};
+
+/* The value a split is compared by.  Splits without one sort after
+ * all splits with one, in either direction: generic-less? never ranks
+ * a #f value first, and this keeps the comparison a strict weak order
+ * for std::stable_sort.  A key only yields values of one kind. */
+struct SortValue
+{
+    enum { INTEGER, NUMERIC, STRING, ABSENT } kind = ABSENT;
+    int64_t integer = 0;
+    gnc_numeric numeric;
+    std::string string;
+};
+
+struct SortLevel
+{
+    SortKey key = SortKey::NONE;
+    DateGroup date_group = DateGroup::NONE;
+    bool ascending = true;
+};
+
+struct GncTrepEngine
+{
+    bool split_action;
+    std::unordered_set<const Account*> filter_accounts;
+    bool filter_active = false;
+    bool filter_exclude = false;
+    std::string matcher;
+    bool matcher_exclude = false;
+    SortLevel levels[2];
+    std::vector<Split*> splits;
+    size_t cursor = 0;
+    std::unordered_map<const Account*, std::string> full_names;
+};
+
+/* Mirrors gnc:date-to-week on the start of the day, with weekstart
+ * taken from gnc-start-of-week as date-utilities.scm does. */
+static int64_t
+week_number (time64 t)
+{
+    static const int64_t week = 7 * 86400;
+    gint weekstart = gnc_start_of_week ();
+    int64_t shifted;
+
+    if (weekstart == 0)
+        weekstart = 1;
+    shifted = gnc_time64_get_day_start (t) - (1 + weekstart) * 86400;
+    return shifted >= 0 ? shifted / week : -((-shifted + week - 1) / week);
+}
+
+static bool
+date_group_value (time64 t, DateGroup group, int64_t *value)
+{
+    struct tm tm;
+    int64_t year;
+
+    if (group == DateGroup::NONE)
+        return false;
+    if (group == DateGroup::WEEK)
+    {
+        *value = week_number (t);
+        return true;
+    }
+    if (!gnc_localtime_r (&t, &tm))
+        return false;
+    year = tm.tm_year + 1900;
+    switch (group)
+    {
+    case DateGroup::DAY:
+        *value = 500 * year + tm.tm_yday + 1;
+        break;
+    case DateGroup::MONTH:
+        *value = 100 * year + tm.tm_mon + 1;
+        break;
+    case DateGroup::QUARTER:
+        *value = 10 * year + tm.tm_mon / 3 + 1;
+        break;
+    default:
+        *value = year;
+        break;
+    }
+    return true;
+}
+
+static const std::string&
+account_full_name (GncTrepEngine *engine, const Account *acc)
+{
+    auto it = engine->full_names.find (acc);
+    if (it == engine->full_names.end ())
+    {
+        gchar *name = gnc_account_get_full_name (acc);
+        it = engine->full_names.emplace (acc, name ? name : "").first;
+        g_free (name);
+    }
+    return it->second;
+}
+
+/* A NULL string reaches Scheme as #f, so it leaves the value absent. */
+static void
+set_string (SortValue& value, const char *str)
+{
+    if (!str)
+        return;
+    value.kind = SortValue::STRING;
+    value.string = str;
+}
+
+static SortValue
+split_sort_value (GncTrepEngine *engine, const SortLevel& level, Split *split)
+{
+    SortValue value;
+    Transaction *trans = xaccSplitGetParent (split);
+
+    switch (level.key)
+    {
+    case SortKey::ACCOUNT_NAME:
+        value.kind = SortValue::STRING;
+        value.string = account_full_name (engine, xaccSplitGetAccount (split));
+        break;
+    case SortKey::ACCOUNT_CODE:
+        set_string (value, xaccAccountGetCode (xaccSplitGetAccount (split)));
+        break;
+    case SortKey::DATE:
+        if (date_group_value (xaccTransGetDate (trans), level.date_group,
+                              &value.integer))
+            value.kind = SortValue::INTEGER;
+        break;
+    case SortKey::RECONCILED_DATE:
+        if (date_group_value (xaccSplitGetDateReconciled (split),
+                              level.date_group, &value.integer))
+            value.kind = SortValue::INTEGER;
+        break;
+    case SortKey::RECONCILED_STATUS:
+    {
+        /* The length of the tail of reconcile-list from the flag on. */
+        static const char order[] = { NREC, CREC, YREC, FREC, VREC };
+        const char *pos = static_cast<const char*>(
+            memchr (order, xaccSplitGetReconcile (split), sizeof (order)));
+        value.kind = SortValue::INTEGER;
+        value.integer = pos ? sizeof (order) - (pos - order) : 0;
+        break;
+    }
+    case SortKey::CORR_ACCOUNT_NAME:
+    {
+        char *name = xaccSplitGetCorrAccountFullName (split);
+        set_string (value, name);
+        g_free (name);
+        break;
+    }
+    case SortKey::CORR_ACCOUNT_CODE:
+        set_string (value, xaccSplitGetCorrAccountCode (split));
+        break;
+    case SortKey::AMOUNT:
+        value.kind = SortValue::NUMERIC;
+        value.numeric = xaccSplitGetValue (split);
+        break;
+    case SortKey::DESCRIPTION:
+        set_string (value, xaccTransGetDescription (trans));
+        break;
+    case SortKey::NUMBER:
+        set_string (value, engine->split_action ? xaccSplitGetAction (split)
+                    : xaccTransGetNum (trans));
+        break;
+    case SortKey::T_NUMBER:
+        set_string (value, xaccTransGetNum (trans));
+        break;
+    case SortKey::MEMO:
+        set_string (value, xaccSplitGetMemo (split));
+        break;
+    case SortKey::NOTES:
+        set_string (value, xaccTransGetNotes (trans));
+        break;
+    default:
+        break;
+    }
+    return value;
+}
+
+static bool
+sort_value_less (const SortValue& x, const SortValue& y, bool ascending)
+{
+    int cmp;
+
+    if (x.kind != y.kind)
+        return x.kind < y.kind;
+    switch (x.kind)
+    {
+    case SortValue::INTEGER:
+        cmp = (x.integer > y.integer) - (x.integer < y.integer);
+        break;
+    case SortValue::NUMERIC:
+        cmp = gnc_numeric_compare (x.numeric, y.numeric);
+        break;
+    case SortValue::STRING:
+        cmp = x.string.compare (y.string);
+        break;
+    default:
+        return false;
+    }
+    return ascending ? cmp < 0 : cmp > 0;
+}
+
+static bool
+split_passes_filters (const GncTrepEngine *engine, const Split *split)
+{
+    const Transaction *trans = xaccSplitGetParent (split);
+
+    if (engine->filter_active)
+    {
+        bool member = false;
+        for (GList *node = xaccTransGetSplitList (trans); node && !member;
+             node = node->next)
+        {
+            auto other = static_cast<const Split*>(node->data);
+            member = other != split &&
+                engine->filter_accounts.count (xaccSplitGetAccount (other));
+        }
+        if (member == engine->filter_exclude)
+            return false;
+    }
+
+    if (!engine->matcher.empty ())
+    {
+        auto contains = [engine](const char *str)
+        {
+            return str && strstr (str, engine->matcher.c_str ());
+        };
+        bool match = contains (xaccTransGetDescription (trans)) ||
+            contains (xaccTransGetNotes (trans)) ||
+            contains (xaccSplitGetMemo (split));
+        if (match == engine->matcher_exclude)
+            return false;
+    }
+    return true;
+}
+
+/* Equivalent to the stable-sort! passes of trep-engine.scm, secondary
+ * key first, then primary.  The values are computed once per split
+ * rather than on every comparison. */
+static void
+sort_splits (GncTrepEngine *engine)
+{
+    const SortLevel& primary = engine->levels[0];
+    const SortLevel& secondary = engine->levels[1];
+    std::vector<SortValue> pvals, svals;
+    std::vector<size_t> order (engine->splits.size ());
+    std::vector<Split*> sorted;
+
+    if (primary.key == SortKey::NONE && secondary.key == SortKey::NONE)
+        return;
+
+    pvals.reserve (order.size ());
+    svals.reserve (order.size ());
+    for (size_t i = 0; i < order.size (); i++)
+    {
+        order[i] = i;
+        pvals.push_back (split_sort_value (engine, primary, engine->splits[i]));
+        svals.push_back (split_sort_value (engine, secondary, engine->splits[i]));
+    }
+
+    std::stable_sort (order.begin (), order.end (),
+                      [&](size_t a, size_t b)
+                      {
+                          if (sort_value_less (pvals[a], pvals[b], primary.ascending))
+                              return true;
+                          if (sort_value_less (pvals[b], pvals[a], primary.ascending))
+                              return false;
+                          return sort_value_less (svals[a], svals[b],
+                                                  secondary.ascending);
+                      });
+
+    sorted.reserve (order.size ());
+    for (auto i : order)
+        sorted.push_back (engine->splits[i]);
+    engine->splits.swap (sorted);
+}
+
+GncTrepEngine *
+gnc_trep_engine_new (gboolean split_action)
+{
+    auto engine = new GncTrepEngine;
+    engine->split_action = split_action;
+    return engine;
+}
+
+void
+gnc_trep_engine_destroy (GncTrepEngine *engine)
+{
+    delete engine;
+}
+
+void
+gnc_trep_engine_set_account_filter (GncTrepEngine *engine,
+                                    AccountList *accounts, gboolean exclude)
+{
+    g_return_if_fail (engine);
+
+    engine->filter_accounts.clear ();
+    for (GList *node = accounts; node; node = node->next)
+        engine->filter_accounts.insert (static_cast<Account*>(node->data));
+    engine->filter_active = true;
+    engine->filter_exclude = exclude;
+}
+
+void
+gnc_trep_engine_set_text_filter (GncTrepEngine *engine, const char *matcher,
+                                 gboolean exclude)
+{
+    g_return_if_fail (engine);
+
+    engine->matcher = matcher ? matcher : "";
+    engine->matcher_exclude = exclude;
+}
+
+gboolean
+gnc_trep_engine_set_sort_key (GncTrepEngine *engine, guint level,
+                              const char *key, const char *date_group,
+                              gboolean ascending)
+{
+    SortLevel sort_level;
+    bool found = false;
+
+    g_return_val_if_fail (engine && key && level < 2, FALSE);
+
+    for (const auto& entry : sort_key_names)
+        if (strcmp (entry.name, key) == 0)
+        {
+            sort_level.key = entry.key;
+            found = true;
+            break;
+        }
+    if (!found)
+    {
+        PWARN ("Unknown sort key %s", key);
+        return FALSE;
+    }
+
+    if (date_group)
+    {
+        found = false;
+        for (const auto& entry : date_group_names)
+            if (strcmp (entry.name, date_group) == 0)
+            {
+                sort_level.date_group = entry.group;
+                found = true;
+                break;
+            }
+        if (!found)
+        {
+            PWARN ("Unknown date grouping %s", date_group);
+            return FALSE;
+        }
+    }
+
+    sort_level.ascending = ascending;
+    engine->levels[level] = sort_level;
+    return TRUE;
+}
+
+guint
+gnc_trep_engine_run (GncTrepEngine *engine, QofQuery *query,
+                     gboolean unique_trans)
+{
+    GList *results;
+
+    g_return_val_if_fail (engine && query, 0);
+    ENTER ("engine %p, query %p", engine, query);
+
+    engine->splits.clear ();
+    engine->cursor = 0;
+    engine->full_names.clear ();
+
+    /* qof_query_run's list belongs to the query, the other one to us. */
+    results = unique_trans ? xaccQueryGetSplitsUniqueTrans (query)
+        : qof_query_run (query);
+    for (GList *node = results; node; node = node->next)
+    {
+        auto split = static_cast<Split*>(node->data);
+        if (split_passes_filters (engine, split))
+            engine->splits.push_back (split);
+    }
+    if (unique_trans)
+        g_list_free (results);
+
+    sort_splits (engine);
+
+    LEAVE ("%zu splits", engine->splits.size ());
+    return engine->splits.size ();
+}
+
+SplitList *
+gnc_trep_engine_next_chunk (GncTrepEngine *engine, guint max_splits)
+{
+    GList *chunk = NULL;
+    size_t end;
+
+    g_return_val_if_fail (engine, NULL);
+
+    end = std::min (engine->splits.size (), engine->cursor + max_splits);
+    for (size_t i = end; i > engine->cursor; i--)
+        chunk = g_list_prepend (chunk, engine->splits[i - 1]);
+    engine->cursor = end;
+    return chunk;
+}
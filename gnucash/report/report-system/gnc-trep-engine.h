@@ -0,0 +1,91 @@
+/********************************************************************
+ * gnc-trep-engine.h -- filtering and sorting for the transaction  *
+ *                      report                                      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/** @file gnc-trep-engine.h
+ *  @brief Runs the split query of trep-engine.scm and does the
+ *  filtering and custom sorting of its results in compiled code.
+ *
+ *  The sort keys and date groupings are named by the symbols used in
+ *  the sortkey-list and date-subtotal-list of trep-engine.scm, and
+ *  compare splits as its generic-less? does.  Splits without a value
+ *  for a key, which generic-less? never ranks first, sort last.
+ */
+
+#ifndef GNC_TREP_ENGINE_H
+#define GNC_TREP_ENGINE_H
+
+#include <glib.h>
+#include "gnc-engine.h"
+#include "qofquery.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct GncTrepEngine GncTrepEngine;
+
+/** Create an engine.  If split_action is TRUE the 'number' sort key
+ *  uses the split action instead of the transaction number, as set by
+ *  the book option. */
+GncTrepEngine *gnc_trep_engine_new (gboolean split_action);
+
+void gnc_trep_engine_destroy (GncTrepEngine *engine);
+
+/** Keep only the splits with (or, if exclude is TRUE, without) another
+ *  split of their transaction in one of the accounts. */
+void gnc_trep_engine_set_account_filter (GncTrepEngine *engine,
+                                         AccountList *accounts,
+                                         gboolean exclude);
+
+/** Keep only the splits whose transaction description, transaction
+ *  notes or memo contain matcher (or, if exclude is TRUE, none of
+ *  which do).  An empty matcher disables the filter. */
+void gnc_trep_engine_set_text_filter (GncTrepEngine *engine,
+                                      const char *matcher,
+                                      gboolean exclude);
+
+/** Sort the splits by key at the given level, 0 being the primary key
+ *  and 1 the secondary.  date_group is only used by the date keys.
+ *  @return FALSE if key or date_group is unknown. */
+gboolean gnc_trep_engine_set_sort_key (GncTrepEngine *engine, guint level,
+                                       const char *key,
+                                       const char *date_group,
+                                       gboolean ascending);
+
+/** Run the query, filter and sort its results and rewind the engine
+ *  to the first split.  The query's own sort order is kept for splits
+ *  that compare equal.
+ *  @return The number of splits left after filtering. */
+guint gnc_trep_engine_run (GncTrepEngine *engine, QofQuery *query,
+                           gboolean unique_trans);
+
+/** Return the next max_splits splits of the result, or fewer at the
+ *  end.  The list must be freed by the caller, the splits not. */
+SplitList *gnc_trep_engine_next_chunk (GncTrepEngine *engine,
+                                       guint max_splits);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_TREP_ENGINE_H */
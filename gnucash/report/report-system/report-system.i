@@ -23,6 +23,7 @@
 /* Includes the header in the wrapper code */
 #include <config.h>
 #include <gnc-report.h>
+#include <gnc-trep-engine.h>
 %}
 #if defined(SWIGGUILE)
 %{
@@ -41,4 +42,18 @@ gint gnc_report_add(SCM report);
 gchar* gnc_get_default_report_font_family();
 
 void gnc_saved_reports_backup (void);
-gboolean gnc_saved_reports_write_to_file (const gchar* report_def, gboolean overwrite);
\ No newline at end of file
+gboolean gnc_saved_reports_write_to_file (const gchar* report_def, gboolean overwrite);
+
+%types(Split *, Account *);
+GLIST_HELPER_INOUT(SplitList, SWIGTYPE_p_Split);
+GLIST_HELPER_INOUT(AccountList, SWIGTYPE_p_Account);
+%typemap(newfree) SplitList * "g_list_free($1);"
+
+GncTrepEngine *gnc_trep_engine_new (gboolean split_action);
+void gnc_trep_engine_destroy (GncTrepEngine *engine);
+void gnc_trep_engine_set_account_filter (GncTrepEngine *engine, AccountList *accounts, gboolean exclude);
+void gnc_trep_engine_set_text_filter (GncTrepEngine *engine, const char *matcher, gboolean exclude);
+gboolean gnc_trep_engine_set_sort_key (GncTrepEngine *engine, guint level, const char *key, const char *date_group, gboolean ascending);
+guint gnc_trep_engine_run (GncTrepEngine *engine, QofQuery *query, gboolean unique_trans);
+%newobject gnc_trep_engine_next_chunk;
+SplitList *gnc_trep_engine_next_chunk (GncTrepEngine *engine, guint max_splits);
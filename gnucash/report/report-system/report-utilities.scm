@@ -457,23 +457,30 @@ flawed. see report-utilities.scm. please update reports.")
 ;;      dates-list (list of time64) - NOTE: IT WILL BE SORTED
 ;;      split->amount - an unary lambda. calling (split->amount split)
 ;;      returns a number, or #f which effectively skips the split.
+;;      if omitted, the split amounts are summed by the engine.
 ;; out: (list bal0 bal1 ...), each entry is a gnc-monetary object
 ;;
 ;; NOTE a prior incarnation accepted a #:ignore-closing? boolean
 ;; keyword which can be reproduced via #:split->amount (lambda (s)
 ;; (and (not (xaccTransGetIsClosingTxn (xaccSplitGetParent s)))
-;; (xaccSplitGetAmount s)))
+;; (xaccSplitGetAmount s))), or without the round trip through scheme
+;; via (gnc-accounts-get-balances-at-dates (list account) dates-list
+;; ACCOUNT-BALANCE-NOCLOSING #f)
 (define* (gnc:account-get-balances-at-dates
-          account dates-list #:key (split->amount xaccSplitGetAmount))
+          account dates-list #:key split->amount)
   (define (amount->monetary bal)
     (gnc:make-gnc-monetary (xaccAccountGetCommodity account) (or bal 0)))
   (define balance 0)
   (map amount->monetary
-       (gnc:account-accumulate-at-dates
-        account dates-list #:split->elt
-        (lambda (s)
-          (if s (set! balance (+ balance (or (split->amount s) 0))))
-          balance))))
+       (if split->amount
+           (gnc:account-accumulate-at-dates
+            account dates-list #:split->elt
+            (lambda (s)
+              (if s (set! balance (+ balance (or (split->amount s) 0))))
+              balance))
+           ;; plain split amounts are summed by the engine
+           (gnc-accounts-get-balances-at-dates
+            (list account) dates-list ACCOUNT-BALANCE-TOTAL #f))))
 
 
 ;; this function will scan through account splitlist, building a list
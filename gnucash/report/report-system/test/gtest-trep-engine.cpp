@@ -0,0 +1,157 @@
+/********************************************************************
+ * gtest-trep-engine.cpp -- unit tests for the transaction report   *
+ *                          engine.                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+#include <gtest/gtest.h>
+extern "C"
+{
+#include <config.h>
+#include <qof.h>
+#include <cashobjects.h>
+#include <Account.h>
+#include <Query.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
+#include <gnc-trep-engine.h>
+}
+#include <string>
+#include <vector>
+
+using StrVec = std::vector<std::string>;
+
+/* Notes of the transactions, posted a day apart in this order.  NULL
+ * leaves a transaction without notes, which Scheme sees as #f. */
+static const char* const test_notes[] =
+{
+    "bravo", nullptr, "alpha", nullptr, "charlie", nullptr, "alpha"
+};
+
+class TrepEngineTest : public ::testing::Test
+{
+protected:
+    static void SetUpTestCase()
+    {
+        qof_init();
+        cashobjects_register();
+    }
+
+    TrepEngineTest() :
+        m_book{qof_book_new()}, m_root{gnc_account_create_root(m_book)},
+        m_engine{gnc_trep_engine_new(FALSE)}
+    {
+        auto usd = gnc_commodity_new(m_book, "US Dollar", "CURRENCY", "USD",
+                                     nullptr, 100);
+        m_bank = make_account("Bank", usd);
+        auto expense = make_account("Expense", usd);
+        for (guint i = 0; i < G_N_ELEMENTS(test_notes); i++)
+        {
+            auto trans = xaccMallocTransaction(m_book);
+            xaccTransBeginEdit(trans);
+            xaccTransSetCurrency(trans, usd);
+            xaccTransSetDatePostedSecsNormalized(trans, (i + 1) * 86400 * 2);
+            xaccTransSetDescription(trans, std::to_string(i).c_str());
+            if (test_notes[i])
+                xaccTransSetNotes(trans, test_notes[i]);
+            auto amount = gnc_numeric_create(100 * (i + 1), 100);
+            make_split(trans, m_bank, gnc_numeric_neg(amount));
+            make_split(trans, expense, amount);
+            xaccTransCommitEdit(trans);
+        }
+    }
+    ~TrepEngineTest()
+    {
+        gnc_trep_engine_destroy(m_engine);
+        xaccAccountBeginEdit(m_root);
+        xaccAccountDestroy(m_root);
+        qof_book_destroy(m_book);
+    }
+
+    Account* make_account(const char* name, gnc_commodity* commodity)
+    {
+        auto account = xaccMallocAccount(m_book);
+        xaccAccountBeginEdit(account);
+        xaccAccountSetName(account, name);
+        xaccAccountSetCommodity(account, commodity);
+        gnc_account_append_child(m_root, account);
+        xaccAccountCommitEdit(account);
+        return account;
+    }
+
+    void make_split(Transaction* trans, Account* account, gnc_numeric amount)
+    {
+        auto split = xaccMallocSplit(m_book);
+        xaccSplitSetParent(split, trans);
+        xaccSplitSetAccount(split, account);
+        xaccSplitSetAmount(split, amount);
+        xaccSplitSetValue(split, amount);
+    }
+
+    /* The descriptions of the bank splits in the order the engine
+     * returns them. */
+    StrVec run()
+    {
+        auto query = qof_query_create_for(GNC_ID_SPLIT);
+        qof_query_set_book(query, m_book);
+        xaccQueryAddSingleAccountMatch(query, m_bank, QOF_QUERY_AND);
+        gnc_trep_engine_run(m_engine, query, FALSE);
+        StrVec result;
+        auto splits = gnc_trep_engine_next_chunk(m_engine, 100);
+        for (auto node = splits; node; node = node->next)
+        {
+            auto trans = xaccSplitGetParent(static_cast<Split*>(node->data));
+            result.push_back(xaccTransGetDescription(trans));
+        }
+        g_list_free(splits);
+        qof_query_destroy(query);
+        return result;
+    }
+
+    QofBook* m_book;
+    Account* m_root;
+    Account* m_bank;
+    GncTrepEngine* m_engine;
+};
+
+/* trep-engine.scm sorted with generic-less?, which never ranks a split
+ * whose notes are #f before another.  The splits without notes come
+ * last, in query order, for both directions. */
+TEST_F(TrepEngineTest, sort_absent_notes_last)
+{
+    ASSERT_TRUE(gnc_trep_engine_set_sort_key(m_engine, 0, "notes", nullptr,
+                                             TRUE));
+    EXPECT_EQ(StrVec({"2", "6", "0", "4", "1", "3", "5"}), run());
+
+    ASSERT_TRUE(gnc_trep_engine_set_sort_key(m_engine, 0, "notes", nullptr,
+                                             FALSE));
+    EXPECT_EQ(StrVec({"4", "0", "2", "6", "1", "3", "5"}), run());
+}
+
+/* The secondary key orders the splits whose primary values are equal,
+ * including those that have none. */
+TEST_F(TrepEngineTest, sort_absent_primary_by_secondary)
+{
+    ASSERT_TRUE(gnc_trep_engine_set_sort_key(m_engine, 0, "notes", nullptr,
+                                             TRUE));
+    ASSERT_TRUE(gnc_trep_engine_set_sort_key(m_engine, 1, "amount", nullptr,
+                                             TRUE));
+    EXPECT_EQ(StrVec({"6", "2", "0", "4", "5", "3", "1"}), run());
+}
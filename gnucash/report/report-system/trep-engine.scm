@@ -1945,16 +1945,6 @@ be excluded from periodic reporting.")
     (gnc:option-value (gnc:lookup-option options section name)))
   (define BOOK-SPLIT-ACTION
     (qof-book-use-split-action-for-num-field (gnc-get-current-book)))
-  (define (is-filter-member split account-list)
-    (define (same-split? s) (equal? s split))
-    (define (from-account? s) (member (xaccSplitGetAccount s) account-list))
-    (let lp ((splits (xaccTransGetSplitList (xaccSplitGetParent split))))
-      (match splits
-        (() #f)
-        (((? same-split?) . rest) (lp rest))
-        (((? from-account?) . _) #t)
-        ((_ . rest) (lp rest)))))
-
   (gnc:report-starting (opt-val gnc:pagename-general gnc:optname-reportname))
 
   (let* ((document (gnc:make-html-document))
@@ -2031,44 +2021,6 @@ be excluded from periodic reporting.")
                        (string-contains str transaction-matcher))))
          (query (qof-query-create-for-splits)))
 
-    (define (generic-less? split-X split-Y sortkey date-subtotal-key ascend?)
-      ;; compare splits X and Y, whereby
-      ;; sortkey and date-subtotal-key specify the options used
-      ;; ascend? specifies whether ascending or descending
-      (let* ((comparator-function
-              (if (memq sortkey DATE-SORTING-TYPES)
-                  (let ((date (keylist-get-info
-                               (sortkey-list BOOK-SPLIT-ACTION)
-                               sortkey 'split-sortvalue))
-                        (date-comparator
-                         (keylist-get-info date-subtotal-list
-                                           date-subtotal-key 'date-sortvalue)))
-                    (lambda (s)
-                      (and date-comparator (date-comparator (date s)))))
-                  (or (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
-                                        sortkey 'split-sortvalue)
-                      (lambda (s) #f))))
-             (value-of-X (comparator-function split-X))
-             (value-of-Y (comparator-function split-Y))
-             (op (if (string? value-of-X)
-                     (if ascend? string<? string>?)
-                     (if ascend? < >))))
-        (and value-of-X (op value-of-X value-of-Y))))
-
-    (define (primary-comparator? X Y)
-      (generic-less? X Y primary-key
-                     primary-date-subtotal
-                     (eq? primary-order 'ascend)))
-
-    (define (secondary-comparator? X Y)
-      (generic-less? X Y secondary-key
-                     secondary-date-subtotal
-                     (eq? secondary-order 'ascend)))
-
-    ;; This will, by default, sort the split list by ascending posted-date.
-    (define (date-comparator? X Y)
-      (generic-less? X Y 'date 'none #t))
-
     (define (transaction-filter-match split)
       (or (match? (xaccTransGetDescription (xaccSplitGetParent split)))
           (match? (xaccTransGetNotes (xaccSplitGetParent split)))
@@ -2134,42 +2086,58 @@ be excluded from periodic reporting.")
          query (eq? primary-order 'ascend) (eq? secondary-order 'ascend)
          #t))
 
-      (if (opt-val "__trep" "unique-transactions")
-          (set! splits (xaccQueryGetSplitsUniqueTrans query))
-          (set! splits (qof-query-run query)))
+      ;; The account filter, the substring matcher and the custom
+      ;; sort are done by the compiled engine. Its result is sorted,
+      ;; so the filters left below keep the order.
+      (let ((trep (gnc-trep-engine-new BOOK-SPLIT-ACTION)))
+        (unless (eq? filter-mode 'none)
+          (gnc-trep-engine-set-account-filter
+           trep c_account_2 (eq? filter-mode 'exclude)))
+        (unless transaction-matcher-regexp
+          (gnc-trep-engine-set-text-filter
+           trep transaction-matcher transaction-filter-exclude?))
+        (when custom-sort?
+          (gnc-trep-engine-set-sort-key
+           trep 0 (symbol->string primary-key)
+           (symbol->string primary-date-subtotal) (eq? primary-order 'ascend))
+          (gnc-trep-engine-set-sort-key
+           trep 1 (symbol->string secondary-key)
+           (symbol->string secondary-date-subtotal)
+           (eq? secondary-order 'ascend)))
+        (gnc-trep-engine-run trep query (opt-val "__trep" "unique-transactions"))
+        (set! splits
+          (let lp ((chunks '()))
+            (match (gnc-trep-engine-next-chunk trep 10000)
+              (() (concatenate! (reverse! chunks)))
+              (chunk (lp (cons chunk chunks))))))
+        (gnc-trep-engine-destroy trep))
 
       (qof-query-destroy query)
 
-      ;; Combined Filter:
+      ;; Remaining Filter:
       ;; - include/exclude using split->date according to date options
-      ;; - include/exclude splits to/from selected accounts
-      ;; - substring/regex matcher for Transaction Description/Notes/Memo
+      ;; - regex matcher for Transaction Description/Notes/Memo
       ;; - custom-split-filter, a split->bool function for derived reports
-      (set! splits
-        (filter
-         (lambda (split)
-           (let* ((trans (xaccSplitGetParent split)))
+      (when (or split->date
+                (and transaction-matcher-regexp
+                     (not (string-null? transaction-matcher)))
+                custom-split-filter)
+        (set! splits
+          (filter
+           (lambda (split)
              (and (or (not split->date)
                       (let ((date (split->date split)))
                         (if date
                             (<= begindate date enddate)
                             split->date-include-false?)))
-                  (case filter-mode
-                    ((none) #t)
-                    ((include) (is-filter-member split c_account_2))
-                    ((exclude) (not (is-filter-member split c_account_2))))
-                  (or (string-null? transaction-matcher)
+                  (or (not transaction-matcher-regexp)
+                      (string-null? transaction-matcher)
                       (if transaction-filter-exclude?
                           (not (transaction-filter-match split))
                           (transaction-filter-match split)))
                   (or (not custom-split-filter)
-                      (custom-split-filter split)))))
-         splits))
-
-      (when custom-sort?
-        (set! splits (stable-sort! splits date-comparator?))
-        (set! splits (stable-sort! splits secondary-comparator?))
-        (set! splits (stable-sort! splits primary-comparator?)))
+                      (custom-split-filter split))))
+           splits)))
 
       (cond
        ((null? splits)
@@ -253,12 +253,10 @@
     (define (account->balancelist account)
       (let ((comm (xaccAccountGetCommodity account)))
         (cons account
-              (gnc:account-accumulate-at-dates
-               account dates-list
-               #:split->elt (lambda (s)
-                              (gnc:make-gnc-monetary
-                               comm (xaccSplitGetNoclosingBalance s)))
-               #:nosplit->elt (gnc:make-gnc-monetary comm 0)))))
+              (map
+               (lambda (bal) (gnc:make-gnc-monetary comm bal))
+               (gnc-accounts-get-balances-at-dates
+                (list account) dates-list ACCOUNT-BALANCE-NOCLOSING #f)))))
 
     ;; This calculates the balances for all the 'account-balances' for
     ;; each element of the list 'dates'. Uses the collector->monetary
@@ -382,6 +382,31 @@ trans_numeric(const char *digit_str,
     return pnum;
 }
 
+/* Shared by the parser callbacks and the compiled expressions. */
+static gnc_numeric
+apply_numeric_op (char op_sym, gnc_numeric left, gnc_numeric right)
+{
+    switch (op_sym)
+    {
+    case ADD_OP:
+        return gnc_numeric_add (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case SUB_OP:
+        return gnc_numeric_sub (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case DIV_OP:
+        return gnc_numeric_div (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case MUL_OP:
+        return gnc_numeric_mul (left, right,
+                                GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    case ASN_OP:
+        return right;
+    default:
+        return gnc_numeric_zero ();
+    }
+}
+
 static void *
 numeric_ops(char op_sym,
             void *left_value,
@@ -395,29 +420,7 @@ numeric_ops(char op_sym,
         return NULL;
 
     result = (op_sym == ASN_OP) ? left : g_new0(ParserNum, 1);
-
-    switch (op_sym)
-    {
-    case ADD_OP:
-        result->value = gnc_numeric_add (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case SUB_OP:
-        result->value = gnc_numeric_sub (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case DIV_OP:
-        result->value = gnc_numeric_div (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case MUL_OP:
-        result->value = gnc_numeric_mul (left->value, right->value,
-                                         GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
-        break;
-    case ASN_OP:
-        result->value = right->value;
-        break;
-    }
+    result->value = apply_numeric_op (op_sym, left->value, right->value);
 
     return result;
 }
@@ -577,7 +580,7 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
             if ( g_hash_table_lookup_extended( varHash, newVars->variable_name,
                                                &maybeKey, &maybeValue ) )
             {
-                g_hash_table_remove( varHash, maybeKey );
+                g_hash_table_steal( varHash, maybeKey );
                 g_free( maybeKey );
                 g_free( maybeValue );
             }
@@ -602,6 +605,398 @@ gnc_exp_parser_parse_separate_vars (const char * expression,
     return last_error == PARSER_NO_ERROR;
 }
 
+/** Compiled expressions *******************************************/
+
+/* An expression is compiled by running the parser once with callbacks
+ * that build a tree instead of computing values, so that it is
+ * tokenized and parsed exactly as gnc_exp_parser_parse_separate_vars
+ * would.  Every name is given a slot in the order the parser first
+ * sees it.  The parser negates values in place, so the binary
+ * operators take copies of their operands: nodes still held by the
+ * parser may change later, the copies never do.
+ *
+ * Assignments and function calls are not compiled. */
+
+#define EXP_CONST 'c'
+#define EXP_VAR   'v'
+#define EXP_NEG   'n'
+
+typedef struct ExpNode
+{
+    char op;            /* EXP_CONST, EXP_VAR, EXP_NEG or a binary op. */
+    gnc_numeric value;  /* EXP_CONST */
+    guint slot;         /* EXP_VAR */
+    struct ExpNode *left;
+    struct ExpNode *right;
+} ExpNode;
+
+typedef struct
+{
+    char op;
+    guint slot;
+    gnc_numeric value;
+} ExpInsn;
+
+struct GncCompiledExp
+{
+    ExpInsn *code;      /* in postfix order */
+    guint code_len;
+    guint stack_depth;
+    guint num_vars;
+    char **var_names;
+};
+
+/* The parser callbacks have no user data, so the state of the
+ * compilation in progress lives here. */
+static GHashTable *compile_nodes = NULL; /* the nodes allocated so far */
+static guint compile_num_vars = 0;
+static gboolean compile_failed = FALSE;
+
+static ExpNode *
+compile_new_node (char op)
+{
+    ExpNode *node = g_new0 (ExpNode, 1);
+    node->op = op;
+    g_hash_table_add (compile_nodes, node);
+    return node;
+}
+
+static ExpNode *
+compile_copy_node (const ExpNode *node)
+{
+    ExpNode *copy = compile_new_node (node->op);
+    *copy = *node;
+    return copy;
+}
+
+static void *
+compile_trans_numeric (const char *digit_str,
+                       gchar      *radix_point,
+                       gchar      *group_char,
+                       char      **rstr)
+{
+    ParserNum *pnum;
+    ExpNode *node;
+
+    /* The parser asks for the initial zero of a new variable without
+     * rstr, and for the numbers in the expression with it. */
+    if (rstr == NULL)
+    {
+        node = compile_new_node (EXP_VAR);
+        node->slot = compile_num_vars++;
+        return node;
+    }
+
+    pnum = trans_numeric (digit_str, radix_point, group_char, rstr);
+    if (pnum == NULL)
+        return NULL;
+
+    node = compile_new_node (EXP_CONST);
+    node->value = pnum->value;
+    g_free (pnum);
+    return node;
+}
+
+static void *
+compile_numeric_ops (char op_sym, void *left_value, void *right_value)
+{
+    ExpNode *node;
+
+    if ((left_value == NULL) || (right_value == NULL))
+        return NULL;
+
+    if (op_sym == ASN_OP)
+    {
+        compile_failed = TRUE;
+        return left_value;
+    }
+
+    node = compile_new_node (op_sym);
+    node->left = compile_copy_node (left_value);
+    node->right = compile_copy_node (right_value);
+    return node;
+}
+
+static void *
+compile_negate_numeric (void *value)
+{
+    ExpNode *node = value;
+    ExpNode *operand;
+
+    if (value == NULL)
+        return NULL;
+
+    operand = compile_copy_node (node);
+    node->op = EXP_NEG;
+    node->left = operand;
+    node->right = NULL;
+    return node;
+}
+
+static void
+compile_free_numeric (void *numeric_value)
+{
+    /* The nodes are freed with compile_nodes; anything else is a
+     * string argument. */
+    if (numeric_value && !g_hash_table_contains (compile_nodes, numeric_value))
+        g_free (numeric_value);
+}
+
+static void *
+compile_func_op (const char *fname, int argc, void **argv)
+{
+    compile_failed = TRUE;
+    return NULL;
+}
+
+/* Appends node in postfix order and returns the stack depth needed to
+ * evaluate it. */
+static guint
+compile_emit (GArray *code, const ExpNode *node)
+{
+    ExpInsn insn = { node->op, node->slot, node->value };
+    guint depth;
+
+    switch (node->op)
+    {
+    case EXP_CONST:
+    case EXP_VAR:
+        depth = 1;
+        break;
+    case EXP_NEG:
+        depth = compile_emit (code, node->left);
+        break;
+    default:
+        depth = compile_emit (code, node->left);
+        depth = MAX (depth, 1 + compile_emit (code, node->right));
+        break;
+    }
+
+    g_array_append_val (code, insn);
+    return depth;
+}
+
+GncCompiledExp *
+gnc_exp_parser_compile (const char *expression)
+{
+    parser_env_ptr pe;
+    var_store_ptr vars;
+    struct lconv *lc;
+    var_store result;
+    char *error_loc;
+    GncCompiledExp *exp = NULL;
+    guint num_vars = 0;
+
+    if (expression == NULL)
+        return NULL;
+
+    g_return_val_if_fail (compile_nodes == NULL, NULL);
+
+    compile_nodes = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                           g_free, NULL);
+    compile_num_vars = 0;
+    compile_failed = FALSE;
+
+    result.variable_name = NULL;
+    result.value = NULL;
+    result.next_var = NULL;
+
+    lc = gnc_localeconv ();
+
+    pe = init_parser (NULL, lc->mon_decimal_point, lc->mon_thousands_sep,
+                      compile_trans_numeric, compile_numeric_ops,
+                      compile_negate_numeric, compile_free_numeric,
+                      compile_func_op);
+
+    error_loc = parse_string (&result, expression, pe);
+
+    for (vars = parser_get_vars (pe); vars; vars = vars->next_var)
+    {
+        if (vars->assign_flag == ASSIGNED_TO)
+            compile_failed = TRUE;
+        num_vars++;
+    }
+
+    if (error_loc == NULL && !compile_failed && result.value != NULL &&
+        num_vars == compile_num_vars)
+    {
+        GArray *code = g_array_new (FALSE, FALSE, sizeof (ExpInsn));
+        guint i;
+
+        exp = g_new0 (GncCompiledExp, 1);
+        exp->stack_depth = compile_emit (code, result.value);
+        exp->code_len = code->len;
+        exp->code = (ExpInsn *) g_array_free (code, FALSE);
+        exp->num_vars = num_vars;
+        exp->var_names = g_new0 (char *, num_vars + 1);
+        for (vars = parser_get_vars (pe), i = 0; vars; vars = vars->next_var, i++)
+            exp->var_names[i] = g_strdup (vars->variable_name);
+    }
+
+    exit_parser (pe);
+
+    g_hash_table_destroy (compile_nodes);
+    compile_nodes = NULL;
+
+    return exp;
+}
+
+void
+gnc_exp_parser_compiled_free (GncCompiledExp *exp)
+{
+    if (exp == NULL)
+        return;
+
+    g_free (exp->code);
+    g_strfreev (exp->var_names);
+    g_free (exp);
+}
+
+guint
+gnc_exp_parser_compiled_num_vars (const GncCompiledExp *exp)
+{
+    g_return_val_if_fail (exp != NULL, 0);
+    return exp->num_vars;
+}
+
+const char *
+gnc_exp_parser_compiled_var_name (const GncCompiledExp *exp, guint index)
+{
+    g_return_val_if_fail (exp != NULL && index < exp->num_vars, NULL);
+    return exp->var_names[index];
+}
+
+static gboolean
+compiled_eval (const GncCompiledExp *exp, const gnc_numeric *values,
+               gnc_numeric *stack, gnc_numeric *value_p)
+{
+    guint i, sp = 0;
+
+    for (i = 0; i < exp->code_len; i++)
+    {
+        const ExpInsn *insn = &exp->code[i];
+
+        switch (insn->op)
+        {
+        case EXP_CONST:
+            stack[sp++] = insn->value;
+            break;
+        case EXP_VAR:
+            stack[sp++] = values[insn->slot];
+            break;
+        case EXP_NEG:
+            stack[sp - 1] = gnc_numeric_neg (stack[sp - 1]);
+            break;
+        default:
+            sp--;
+            stack[sp - 1] = apply_numeric_op (insn->op, stack[sp - 1], stack[sp]);
+            break;
+        }
+    }
+
+    if (gnc_numeric_check (stack[0]))
+    {
+        last_error = NUMERIC_ERROR;
+        return FALSE;
+    }
+
+    if (value_p)
+        *value_p = gnc_numeric_reduce (stack[0]);
+
+    last_error = PARSER_NO_ERROR;
+    return TRUE;
+}
+
+gboolean
+gnc_exp_parser_compiled_eval (const GncCompiledExp *exp,
+                              const gnc_numeric *values,
+                              gnc_numeric *value_p)
+{
+    gnc_numeric *stack;
+    gboolean ret;
+
+    g_return_val_if_fail (exp != NULL, FALSE);
+    g_return_val_if_fail (values != NULL || exp->num_vars == 0, FALSE);
+
+    stack = g_new (gnc_numeric, exp->stack_depth);
+    ret = compiled_eval (exp, values, stack, value_p);
+    g_free (stack);
+
+    return ret;
+}
+
+gboolean
+gnc_exp_parser_compiled_eval_vars (const GncCompiledExp *exp,
+                                   GHashTable *varHash,
+                                   gnc_numeric *value_p)
+{
+    gnc_numeric *values;
+    gboolean ret;
+    guint i;
+
+    g_return_val_if_fail (exp != NULL, FALSE);
+
+    if (!parser_inited)
+        gnc_exp_parser_real_init ( (varHash == NULL) );
+
+    /* Look the names up as the parser would: in varHash, then in the
+     * global variables, and otherwise start at zero. */
+    values = g_new0 (gnc_numeric, exp->num_vars + 1);
+    for (i = 0; i < exp->num_vars; i++)
+    {
+        gpointer value;
+        ParserNum *pnum;
+
+        if (varHash != NULL &&
+            g_hash_table_lookup_extended (varHash, exp->var_names[i],
+                                          NULL, &value))
+        {
+            if (value != NULL)
+                values[i] = *(gnc_numeric *) value;
+        }
+        else if ((pnum = g_hash_table_lookup (variable_bindings,
+                                              exp->var_names[i])))
+            values[i] = pnum->value;
+        else
+            values[i] = gnc_numeric_zero ();
+    }
+
+    ret = gnc_exp_parser_compiled_eval (exp, values, value_p);
+    g_free (values);
+
+    return ret;
+}
+
+gboolean
+gnc_exp_parser_compiled_eval_batch (const GncCompiledExp *exp,
+                                    const gnc_numeric *values,
+                                    guint n_sets,
+                                    gnc_numeric *results)
+{
+    gnc_numeric *stack;
+    gboolean all_ok = TRUE;
+    guint i;
+
+    g_return_val_if_fail (exp != NULL && results != NULL, FALSE);
+    g_return_val_if_fail (values != NULL || exp->num_vars == 0, FALSE);
+
+    stack = g_new (gnc_numeric, exp->stack_depth);
+    for (i = 0; i < n_sets; i++)
+    {
+        const gnc_numeric *set = values ? values + (gsize) i * exp->num_vars : NULL;
+
+        if (!compiled_eval (exp, set, stack, &results[i]))
+        {
+            results[i] = stack[0];
+            all_ok = FALSE;
+        }
+    }
+    g_free (stack);
+
+    last_error = all_ok ? PARSER_NO_ERROR : NUMERIC_ERROR;
+    return all_ok;
+}
+
 const char *
 gnc_exp_parser_error_string (void)
 {
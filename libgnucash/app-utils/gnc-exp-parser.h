@@ -85,6 +85,57 @@ gboolean gnc_exp_parser_parse_separate_vars (const char * expression,
         char **error_loc_p,
         GHashTable *varHash );
 
+/**
+ * An expression parsed once, to be evaluated many times with different
+ * variable values.  Its variables are numbered in the order they first
+ * appear in the expression.
+ **/
+typedef struct GncCompiledExp GncCompiledExp;
+
+/**
+ * Compiles the expression.  Returns NULL if the expression does not
+ * parse, or if it assigns to a variable or calls a function; those
+ * must go through gnc_exp_parser_parse_separate_vars.
+ **/
+GncCompiledExp *gnc_exp_parser_compile (const char *expression);
+
+void gnc_exp_parser_compiled_free (GncCompiledExp *exp);
+
+guint gnc_exp_parser_compiled_num_vars (const GncCompiledExp *exp);
+
+/* The name of the variable with the given index. */
+const char *gnc_exp_parser_compiled_var_name (const GncCompiledExp *exp,
+                                              guint index);
+
+/**
+ * Evaluates the expression with values[i] for the variable with index
+ * i.  Returns TRUE and sets *value_p like gnc_exp_parser_parse, or
+ * FALSE if the result is a numeric error.
+ **/
+gboolean gnc_exp_parser_compiled_eval (const GncCompiledExp *exp,
+                                       const gnc_numeric *values,
+                                       gnc_numeric *value_p);
+
+/**
+ * Evaluates the expression with the variables of varHash, as
+ * gnc_exp_parser_parse_separate_vars would, except that varHash is
+ * not changed.
+ **/
+gboolean gnc_exp_parser_compiled_eval_vars (const GncCompiledExp *exp,
+                                            GHashTable *varHash,
+                                            gnc_numeric *value_p);
+
+/**
+ * Evaluates the expression for n_sets sets of variable values, set i
+ * being values[i * num_vars] to values[i * num_vars + num_vars - 1].
+ * A set whose result is a numeric error gets that error in results.
+ * Returns TRUE if every set evaluated.
+ **/
+gboolean gnc_exp_parser_compiled_eval_batch (const GncCompiledExp *exp,
+                                             const gnc_numeric *values,
+                                             guint n_sets,
+                                             gnc_numeric *results);
+
 /* If the last parse returned FALSE, return an error string describing
  * the problem. Otherwise, return NULL. */
 const char * gnc_exp_parser_error_string (void);
@@ -69,6 +69,7 @@ static void gnc_sx_instance_model_class_init (GncSxInstanceModelClass *klass);
 static void gnc_sx_instance_model_init(GTypeInstance *instance, gpointer klass);
 static GncSxInstanceModel* gnc_sx_instance_model_new(void);
 
+static void gnc_sx_instances_free(GncSxInstances *instances);
 static GncSxInstance* gnc_sx_instance_new(GncSxInstances *parent, GncSxInstanceState state, GDate *date, void *temporal_state, gint sequence_num);
 
 static gint _get_vars_helper(Transaction *txn, void *var_hash_data);
@@ -133,6 +134,87 @@ gnc_sx_scrub_split_numerics (gpointer psplit, gpointer puser)
         xaccTransCommitEdit (trans);
 }
 
+/* The variable names used by each template formula, keyed by formula
+ * text so that an edited formula simply misses.  The cache is emptied
+ * when it grows past FORMULA_VARS_CACHE_MAX entries. */
+#define FORMULA_VARS_CACHE_MAX 4096
+static GHashTable *formula_vars_cache = NULL; /* <char*,GList<char*>> */
+
+static void
+_free_var_name_list(GList *names)
+{
+    g_list_free_full(names, g_free);
+}
+
+static void
+_take_parsed_var_name(gchar *name, gnc_numeric *value, GList **names)
+{
+    *names = g_list_prepend(*names, name);
+    g_free(value);
+}
+
+static GList*
+_get_formula_var_names(const char *formula)
+{
+    GHashTable *parser_vars;
+    GList *names = NULL;
+    gnc_numeric num;
+    char *err_loc = NULL;
+    gpointer cached;
+
+    if (formula_vars_cache == NULL)
+        formula_vars_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                                   (GDestroyNotify)_free_var_name_list);
+    else if (g_hash_table_lookup_extended(formula_vars_cache, formula, NULL, &cached))
+        return (GList*)cached;
+
+    /* The parser hands over the names and values it allocated. */
+    parser_vars = g_hash_table_new(g_str_hash, g_str_equal);
+    gnc_exp_parser_parse_separate_vars(formula, &num, &err_loc, parser_vars);
+    g_hash_table_foreach(parser_vars, (GHFunc)_take_parsed_var_name, &names);
+    g_hash_table_destroy(parser_vars);
+
+    if (g_hash_table_size(formula_vars_cache) >= FORMULA_VARS_CACHE_MAX)
+        g_hash_table_remove_all(formula_vars_cache);
+    g_hash_table_insert(formula_vars_cache, g_strdup(formula), names);
+    return names;
+}
+
+/* The compiled template formulas, keyed by formula text; NULL for the
+ * formulas that must go through the full parser. */
+static GHashTable *compiled_formula_cache = NULL; /* <char*,GncCompiledExp*> */
+
+static GncCompiledExp*
+_get_compiled_formula(const char *formula)
+{
+    GncCompiledExp *compiled;
+    gpointer cached;
+
+    if (compiled_formula_cache == NULL)
+        compiled_formula_cache = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                                       (GDestroyNotify)gnc_exp_parser_compiled_free);
+    else if (g_hash_table_lookup_extended(compiled_formula_cache, formula, NULL, &cached))
+        return (GncCompiledExp*)cached;
+
+    compiled = gnc_exp_parser_compile(formula);
+    if (g_hash_table_size(compiled_formula_cache) >= FORMULA_VARS_CACHE_MAX)
+        g_hash_table_remove_all(compiled_formula_cache);
+    g_hash_table_insert(compiled_formula_cache, g_strdup(formula), compiled);
+    return compiled;
+}
+
+static void
+_add_formula_vars(const char *formula, GHashTable *var_hash)
+{
+    GList *names = _get_formula_var_names(formula);
+    for (; names != NULL; names = names->next)
+    {
+        gchar *name = (gchar*)names->data;
+        if (!g_hash_table_lookup_extended(var_hash, name, NULL, NULL))
+            g_hash_table_insert(var_hash, g_strdup(name), gnc_sx_variable_new(name));
+    }
+}
+
 static void
 _sx_var_to_raw_numeric(gchar *name, GncSxVariable *var, GHashTable *parser_var_hash)
 {
@@ -271,12 +353,12 @@ _get_vars_helper(Transaction *txn, void *var_hash_data)
         // existing... ------------------------------------------
 	if (credit_formula && strlen(credit_formula) != 0)
 	{
-	    gnc_sx_parse_vars_from_formula(credit_formula, var_hash, NULL);
+	    _add_formula_vars(credit_formula, var_hash);
 	    split_is_marker = FALSE;
 	}
 	if (debit_formula && strlen(debit_formula) != 0)
 	{
-	    gnc_sx_parse_vars_from_formula(debit_formula, var_hash, NULL);
+	    _add_formula_vars(debit_formula, var_hash);
 	    split_is_marker = FALSE;
 	}
 	g_free (credit_formula);
@@ -411,6 +493,49 @@ gnc_sx_instance_get_variables(GncSxInstance *inst)
     return vars;
 }
 
+static void
+_gnc_sx_get_range_ends(SchedXaction *sx, const GDate *range_end,
+                       GDate *creation_end, GDate *remind_end)
+{
+    *creation_end = *range_end;
+    g_date_add_days(creation_end, xaccSchedXactionGetAdvanceCreation(sx));
+    *remind_end = *creation_end;
+    g_date_add_days(remind_end, xaccSchedXactionGetAdvanceReminder(sx));
+}
+
+/* Appends the to-create instances up to creation_end and then the
+ * reminders up to remind_end, starting from temporal_state. */
+static void
+_gnc_sx_append_instances(GncSxInstances *instances,
+                         SXTmpStateData *temporal_state,
+                         const GDate *creation_end, const GDate *remind_end)
+{
+    SchedXaction *sx = instances->sx;
+    GList *new_instances = NULL;
+    GDate cur_date;
+
+    g_date_clear(&cur_date, 1);
+    cur_date = xaccSchedXactionGetNextInstance(sx, temporal_state);
+    while (g_date_valid(&cur_date) && g_date_compare(&cur_date, remind_end) <= 0)
+    {
+        GncSxInstance *inst;
+        GncSxInstanceState state;
+        int seq_num;
+
+        state = g_date_compare(&cur_date, creation_end) <= 0
+            ? SX_INSTANCE_STATE_TO_CREATE : SX_INSTANCE_STATE_REMINDER;
+        seq_num = gnc_sx_get_instance_count(sx, temporal_state);
+        inst = gnc_sx_instance_new(instances, state, &cur_date,
+                                   temporal_state, seq_num);
+        new_instances = g_list_prepend(new_instances, inst);
+        gnc_sx_incr_temporal_state(sx, temporal_state);
+        cur_date = xaccSchedXactionGetNextInstance(sx, temporal_state);
+    }
+
+    instances->instance_list = g_list_concat(instances->instance_list,
+                                             g_list_reverse(new_instances));
+}
+
 static GncSxInstances*
 _gnc_sx_gen_instances(gpointer *data, gpointer user_data)
 {
@@ -418,15 +543,11 @@ _gnc_sx_gen_instances(gpointer *data, gpointer user_data)
     SchedXaction *sx = (SchedXaction*)data;
     const GDate *range_end = (const GDate*)user_data;
     GDate creation_end, remind_end;
-    GDate cur_date;
     SXTmpStateData *temporal_state = gnc_sx_create_temporal_state(sx);
 
     instances->sx = sx;
 
-    creation_end = *range_end;
-    g_date_add_days(&creation_end, xaccSchedXactionGetAdvanceCreation(sx));
-    remind_end = creation_end;
-    g_date_add_days(&remind_end, xaccSchedXactionGetAdvanceReminder(sx));
+    _gnc_sx_get_range_ends(sx, range_end, &creation_end, &remind_end);
 
     /* postponed */
     {
@@ -450,38 +571,71 @@ _gnc_sx_gen_instances(gpointer *data, gpointer user_data)
         }
     }
 
-    /* to-create */
-    g_date_clear(&cur_date, 1);
-    cur_date = xaccSchedXactionGetNextInstance(sx, temporal_state);
-    instances->next_instance_date = cur_date;
-    while (g_date_valid(&cur_date) && g_date_compare(&cur_date, &creation_end) <= 0)
+    /* to-create and reminders */
+    g_date_clear(&instances->next_instance_date, 1);
+    instances->next_instance_date = xaccSchedXactionGetNextInstance(sx, temporal_state);
+    _gnc_sx_append_instances(instances, temporal_state, &creation_end, &remind_end);
+    gnc_sx_destroy_temporal_state(temporal_state);
+
+    return instances;
+}
+
+/* Generates the instances of an SX that fall between the end of the
+ * model's old range and range_end, which must not be earlier. Returns
+ * whether any instance was added or changed. */
+static gboolean
+_gnc_sx_extend_instances(GncSxInstances *instances, const GDate *range_end)
+{
+    SchedXaction *sx = instances->sx;
+    GDate creation_end, remind_end;
+    SXTmpStateData *temporal_state;
+    GncSxInstance *last;
+    GList *iter;
+    guint old_length;
+    gboolean changed = FALSE;
+
+    if (instances->instance_list == NULL)
     {
-        GncSxInstance *inst;
-        int seq_num;
-        seq_num = gnc_sx_get_instance_count(sx, temporal_state);
-        inst = gnc_sx_instance_new(instances, SX_INSTANCE_STATE_TO_CREATE,
-                                   &cur_date, temporal_state, seq_num);
-        instances->instance_list = g_list_append(instances->instance_list, inst);
-        gnc_sx_incr_temporal_state(sx, temporal_state);
-        cur_date = xaccSchedXactionGetNextInstance(sx, temporal_state);
+        /* Nothing to continue from: nothing is postponed either, so
+         * the SX is cheap to generate from scratch. */
+        GncSxInstances *new_instances = _gnc_sx_gen_instances((gpointer)sx, (gpointer)range_end);
+        for (iter = new_instances->instance_list; iter != NULL; iter = iter->next)
+            ((GncSxInstance*)iter->data)->parent = instances;
+        instances->instance_list = new_instances->instance_list;
+        instances->next_instance_date = new_instances->next_instance_date;
+        if (!instances->variable_names_parsed)
+        {
+            instances->variable_names = new_instances->variable_names;
+            instances->variable_names_parsed = new_instances->variable_names_parsed;
+            new_instances->variable_names = NULL;
+        }
+        new_instances->instance_list = NULL;
+        gnc_sx_instances_free(new_instances);
+        return instances->instance_list != NULL;
     }
 
-    /* reminders */
-    while (g_date_valid(&cur_date) &&
-           g_date_compare(&cur_date, &remind_end) <= 0)
+    _gnc_sx_get_range_ends(sx, range_end, &creation_end, &remind_end);
+
+    for (iter = instances->instance_list; iter != NULL; iter = iter->next)
     {
-        GncSxInstance *inst;
-        int seq_num;
-        seq_num = gnc_sx_get_instance_count(sx, temporal_state);
-        inst = gnc_sx_instance_new(instances, SX_INSTANCE_STATE_REMINDER,
-                                   &cur_date, temporal_state, seq_num);
-        instances->instance_list = g_list_append(instances->instance_list,
-                                                 inst);
-        gnc_sx_incr_temporal_state(sx, temporal_state);
-        cur_date = xaccSchedXactionGetNextInstance(sx, temporal_state);
+        GncSxInstance *inst = (GncSxInstance*)iter->data;
+        if (inst->orig_state != SX_INSTANCE_STATE_REMINDER
+            || g_date_compare(&inst->date, &creation_end) > 0)
+            continue;
+        inst->orig_state = SX_INSTANCE_STATE_TO_CREATE;
+        if (inst->state == SX_INSTANCE_STATE_REMINDER)
+            inst->state = SX_INSTANCE_STATE_TO_CREATE;
+        changed = TRUE;
     }
 
-    return instances;
+    old_length = g_list_length(instances->instance_list);
+    last = (GncSxInstance*)g_list_last(instances->instance_list)->data;
+    temporal_state = gnc_sx_clone_temporal_state(last->temporal_state);
+    gnc_sx_incr_temporal_state(sx, temporal_state);
+    _gnc_sx_append_instances(instances, temporal_state, &creation_end, &remind_end);
+    gnc_sx_destroy_temporal_state(temporal_state);
+
+    return changed || g_list_length(instances->instance_list) != old_length;
 }
 
 GncSxInstanceModel*
@@ -687,6 +841,8 @@ gnc_sx_instance_model_init(GTypeInstance *instance, gpointer klass)
 
     g_date_clear(&inst->range_end, 1);
     inst->sx_instance_list = NULL;
+    inst->updating_sx = NULL;
+    inst->updating_sx_done = FALSE;
     inst->qof_event_handler_id = qof_event_register_handler(_gnc_sx_instance_event_handler, inst);
 }
 
@@ -725,7 +881,14 @@ _gnc_sx_instance_event_handler(QofInstance *ent, QofEventId event_type, gpointer
             {
                 if (instances->include_disabled || xaccSchedXactionGetEnabled(sx))
                 {
+                    SchedXaction *outer_sx = instances->updating_sx;
+                    gboolean outer_done = instances->updating_sx_done;
+
+                    instances->updating_sx = sx;
+                    instances->updating_sx_done = FALSE;
                     g_signal_emit_by_name(instances, "updated", (gpointer)sx);
+                    instances->updating_sx = outer_sx;
+                    instances->updating_sx_done = outer_done;
                 }
                 else
                 {
@@ -806,6 +969,13 @@ gnc_sx_instance_model_update_sx_instances(GncSxInstanceModel *model, SchedXactio
     GncSxInstances *existing, *new_instances;
     GList *link;
 
+    if (sx == model->updating_sx)
+    {
+        if (model->updating_sx_done)
+            return;
+        model->updating_sx_done = TRUE;
+    }
+
     link = g_list_find_custom(model->sx_instance_list, sx, (GCompareFunc)_gnc_sx_instance_find_by_sx);
     if (link == NULL)
     {
@@ -944,6 +1114,41 @@ gnc_sx_instance_model_remove_sx_instances(GncSxInstanceModel *model, SchedXactio
     gnc_sx_instances_free((GncSxInstances*)instance_link->data);
 }
 
+void
+gnc_sx_instance_model_set_range_end(GncSxInstanceModel *model, const GDate *range_end)
+{
+    gboolean shrinking;
+    GList *iter;
+
+    g_return_if_fail(range_end != NULL && g_date_valid(range_end));
+
+    if (g_date_compare(range_end, &model->range_end) == 0)
+        return;
+
+    shrinking = g_date_compare(range_end, &model->range_end) < 0;
+    model->range_end = *range_end;
+    for (iter = model->sx_instance_list; iter != NULL; iter = iter->next)
+    {
+        GncSxInstances *instances = (GncSxInstances*)iter->data;
+        SchedXaction *sx = instances->sx;
+        SchedXaction *outer_sx = model->updating_sx;
+        gboolean outer_done = model->updating_sx_done;
+
+        if (shrinking)
+            gnc_sx_instance_model_update_sx_instances(model, sx);
+        else if (!_gnc_sx_extend_instances(instances, range_end))
+            continue;
+
+        /* The instances are up to date already, so the handlers' calls
+         * to gnc_sx_instance_model_update_sx_instances do nothing. */
+        model->updating_sx = sx;
+        model->updating_sx_done = TRUE;
+        g_signal_emit_by_name(model, "updated", (gpointer)sx);
+        model->updating_sx = outer_sx;
+        model->updating_sx_done = outer_done;
+    }
+}
+
 static void
 increment_sx_state(GncSxInstance *inst, GDate **last_occur_date, int *instance_count, int *remain_occur_count)
 {
@@ -1030,14 +1235,27 @@ _get_sx_formula_value(const SchedXaction* sx,
     if (formula_str != NULL && strlen(formula_str) != 0)
     {
         GHashTable *parser_vars = NULL;
+        GncCompiledExp *compiled = NULL;
+        gboolean parsed;
         if (variable_bindings)
         {
             parser_vars = gnc_sx_instance_get_variables_for_parser(variable_bindings);
+            /* Without bindings the parser updates its global variables,
+             * which the compiled formulas don't. */
+            compiled = _get_compiled_formula(formula_str);
+        }
+        if (compiled != NULL)
+        {
+            parsed = gnc_exp_parser_compiled_eval_vars(compiled, parser_vars, numeric);
+            if (!parsed)
+                parseErrorLoc = formula_str;
         }
-        if (!gnc_exp_parser_parse_separate_vars(formula_str,
-                                                numeric,
-                                                &parseErrorLoc,
-                                                parser_vars))
+        else
+            parsed = gnc_exp_parser_parse_separate_vars(formula_str,
+                                                        numeric,
+                                                        &parseErrorLoc,
+                                                        parser_vars);
+        if (!parsed)
         {
             gchar *err = N_("Error parsing SX [%s] key [%s]=formula [%s] at [%s]: %s.");
             REPORT_ERROR(creation_errors, err,
@@ -1617,14 +1835,116 @@ GHashTable* gnc_g_hash_new_guid_numeric()
                                   NULL, gnc_numeric_free);
 }
 
+/* The cash flow of an SX is the sum over its template splits of debit
+ * minus credit, times the number of occurrences in the date range.
+ * Both parts are kept with the SX between calls: the per-split amounts
+ * of a single occurrence and the occurrence counts of the ranges asked
+ * for.  They are dropped when anything is added, changed or removed in
+ * an SX, transaction, split or account, and when the SX's own temporal
+ * state differs from the one they were computed from, so that changes
+ * made while events were suspended are noticed as well.
+ *
+ * Counting occurrences walks the recurrence from the SX's last
+ * occurrence, which is what dominates long ranges; it only reads the
+ * SX, so uncached counts are computed on worker threads.  The formulas
+ * are evaluated on the calling thread because the expression parser
+ * keeps global state.
+ */
+
+/* Don't bother starting a thread for less than this many SXes. */
+#define CASHFLOW_MIN_SX_PER_THREAD 8
+/* Forget the counts of an SX when it has more ranges than this. */
+#define CASHFLOW_MAX_CACHED_RANGES 1024
+#define CASHFLOW_CACHE_KEY "gnc-sx-cashflow-cache"
+
+static guint cashflow_generation = 0;
+static gint cashflow_event_handler_id = 0;
+
 typedef struct
 {
-    GHashTable *hash;
+    Account *account;
+    gnc_numeric amount; /* debit minus credit of a single occurrence */
+} SxCashflowSplit;
+
+typedef struct
+{
+    guint generation;
+    SXTmpStateData state;
+    gboolean have_amounts;
+    GArray *amounts; /* <SxCashflowSplit> */
+    GHashTable *counts; /* <gint64*,gint> keyed by the julian days */
+} SxCashflowCache;
+
+typedef struct
+{
+    GArray *amounts;
     GList **creation_errors;
     const SchedXaction *sx;
-    gnc_numeric count;
 } SxCashflowData;
 
+static void
+_cashflow_event_handler(QofInstance *ent, QofEventId event_type,
+                        gpointer user_data, gpointer evt_data)
+{
+    if (GNC_IS_SX(ent) || GNC_IS_SXES(ent) || GNC_IS_TRANSACTION(ent) ||
+        GNC_IS_SPLIT(ent) || GNC_IS_ACCOUNT(ent))
+        ++cashflow_generation;
+}
+
+static void
+_cashflow_cache_free(SxCashflowCache *cache)
+{
+    g_array_free(cache->amounts, TRUE);
+    g_hash_table_destroy(cache->counts);
+    g_free(cache);
+}
+
+static gboolean
+_same_temporal_state(const SXTmpStateData *a, const SXTmpStateData *b)
+{
+    return g_date_compare(&a->last_date, &b->last_date) == 0
+        && a->num_occur_rem == b->num_occur_rem
+        && a->num_inst == b->num_inst;
+}
+
+/* Returns the cache of sx, emptied if it is out of date. */
+static SxCashflowCache*
+_get_cashflow_cache(const SchedXaction *sx)
+{
+    SchedXaction *mutable_sx = (SchedXaction*)sx;
+    SxCashflowCache *cache = g_object_get_data(G_OBJECT(mutable_sx), CASHFLOW_CACHE_KEY);
+    SXTmpStateData *state = gnc_sx_create_temporal_state(sx);
+
+    if (cache == NULL)
+    {
+        cache = g_new0(SxCashflowCache, 1);
+        cache->amounts = g_array_new(FALSE, FALSE, sizeof(SxCashflowSplit));
+        cache->counts = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, NULL);
+        g_object_set_data_full(G_OBJECT(mutable_sx), CASHFLOW_CACHE_KEY, cache,
+                               (GDestroyNotify)_cashflow_cache_free);
+    }
+    else if (cache->generation != cashflow_generation ||
+             !_same_temporal_state(&cache->state, state))
+    {
+        g_array_set_size(cache->amounts, 0);
+        cache->have_amounts = FALSE;
+        g_hash_table_remove_all(cache->counts);
+    }
+    cache->generation = cashflow_generation;
+    cache->state = *state;
+    gnc_sx_destroy_temporal_state(state);
+    return cache;
+}
+
+static gboolean
+_cashflow_range_key(const GDate *range_start, const GDate *range_end, gint64 *key)
+{
+    if (!g_date_valid(range_start) || !g_date_valid(range_end))
+        return FALSE;
+    *key = ((gint64)g_date_get_julian(range_start) << 32) | g_date_get_julian(range_end);
+    return TRUE;
+}
+
 static void add_to_hash_amount(GHashTable* hash, const GncGUID* guid, const gnc_numeric* amount)
 {
     /* Do we have a number belonging to this GUID in the hash? If yes,
@@ -1730,8 +2050,7 @@ create_cashflow_helper(Transaction *template_txn, void *user_data)
         {
             gnc_numeric credit_num = gnc_numeric_zero();
             gnc_numeric debit_num = gnc_numeric_zero();
-            gnc_numeric final_once, final;
-            gint gncn_error;
+            SxCashflowSplit flow;
 
             /* Credit value */
             _get_sx_formula_value(creation_data->sx, template_split,
@@ -1743,22 +2062,10 @@ create_cashflow_helper(Transaction *template_txn, void *user_data)
 				  &debit_num, creation_data->creation_errors,
 				  "sx-debit-formula", "sx-debit-numeric", NULL);
 
-            /* The resulting cash flow number: debit minus credit,
-             * multiplied with the count factor. */
-            final_once = gnc_numeric_sub_fixed( debit_num, credit_num );
-            /* Multiply with the count factor. */
-            final = gnc_numeric_mul(final_once, creation_data->count,
-                                    gnc_numeric_denom(final_once),
-                                    GNC_HOW_RND_ROUND_HALF_UP);
-
-            gncn_error = gnc_numeric_check(final);
-            if (gncn_error != GNC_ERROR_OK)
-            {
-                gchar* err = N_("Error %d in SX [%s] final gnc_numeric value, using 0 instead.");
-                REPORT_ERROR(creation_data->creation_errors, err,
-                             gncn_error, xaccSchedXactionGetName(creation_data->sx));
-                final = gnc_numeric_zero();
-            }
+            /* The cash flow of a single occurrence: debit minus
+             * credit. */
+            flow.account = split_acct;
+            flow.amount = gnc_numeric_sub_fixed( debit_num, credit_num );
 
             /* Print error message if we would have needed an exchange rate */
             if (! gnc_commodity_equal(split_cmdty, first_cmdty))
@@ -1768,11 +2075,10 @@ create_cashflow_helper(Transaction *template_txn, void *user_data)
                              xaccSchedXactionGetName(creation_data->sx),
                              gnc_commodity_get_mnemonic(split_cmdty),
                              gnc_commodity_get_mnemonic(first_cmdty));
-                final = gnc_numeric_zero();
+                flow.amount = gnc_numeric_zero();
             }
 
-            /* And add the resulting value to the hash */
-            add_to_hash_amount(creation_data->hash, xaccAccountGetGUID(split_acct), &final);
+            g_array_append_val(creation_data->amounts, flow);
         }
     }
 
@@ -1781,11 +2087,13 @@ create_cashflow_helper(Transaction *template_txn, void *user_data)
 
 static void
 instantiate_cashflow_internal(const SchedXaction* sx,
+                              SxCashflowCache *cache,
                               GHashTable* map,
                               GList **creation_errors, gint count)
 {
-    SxCashflowData create_cashflow_data;
     Account* sx_template_account = gnc_sx_get_template_transaction_account(sx);
+    gnc_numeric count_num;
+    guint i;
 
     if (!sx_template_account)
     {
@@ -1800,62 +2108,196 @@ instantiate_cashflow_internal(const SchedXaction* sx,
         return;
     }
 
-    create_cashflow_data.hash = map;
-    create_cashflow_data.creation_errors = creation_errors;
-    create_cashflow_data.sx = sx;
-    create_cashflow_data.count = gnc_numeric_create(count, 1);
+    if (!cache->have_amounts)
+    {
+        SxCashflowData create_cashflow_data;
+        GList *errors = NULL;
+
+        g_array_set_size(cache->amounts, 0);
+        create_cashflow_data.amounts = cache->amounts;
+        create_cashflow_data.creation_errors = &errors;
+        create_cashflow_data.sx = sx;
+
+        /* The cash flow numbers are in the transactions of the template
+         * account, so run this foreach on the transactions. */
+        xaccAccountForEachTransaction(sx_template_account,
+                                      create_cashflow_helper,
+                                      &create_cashflow_data);
+
+        /* Evaluate again next time so that the errors are reported
+         * again. */
+        cache->have_amounts = (errors == NULL);
+        if (creation_errors != NULL)
+            *creation_errors = g_list_concat(*creation_errors, errors);
+        else
+            g_list_free_full(errors, g_free);
+    }
 
-    /* The cash flow numbers are in the transactions of the template
-     * account, so run this foreach on the transactions. */
-    xaccAccountForEachTransaction(sx_template_account,
-                                  create_cashflow_helper,
-                                  &create_cashflow_data);
+    count_num = gnc_numeric_create(count, 1);
+    for (i = 0; i < cache->amounts->len; i++)
+    {
+        SxCashflowSplit *flow = &g_array_index(cache->amounts, SxCashflowSplit, i);
+        gnc_numeric final;
+        gint gncn_error;
+
+        /* Multiply with the count factor. */
+        final = gnc_numeric_mul(flow->amount, count_num,
+                                gnc_numeric_denom(flow->amount),
+                                GNC_HOW_RND_ROUND_HALF_UP);
+
+        gncn_error = gnc_numeric_check(final);
+        if (gncn_error != GNC_ERROR_OK)
+        {
+            gchar* err = N_("Error %d in SX [%s] final gnc_numeric value, using 0 instead.");
+            REPORT_ERROR(creation_errors, err,
+                         gncn_error, xaccSchedXactionGetName(sx));
+            final = gnc_numeric_zero();
+        }
+
+        /* And add the resulting value to the hash */
+        add_to_hash_amount(map, xaccAccountGetGUID(flow->account), &final);
+    }
 }
 
 typedef struct
 {
-    GHashTable *hash;
-    GList **creation_errors;
+    const SchedXaction *sx;
+    SxCashflowCache *cache;
+    gint count;
+    gboolean count_known;
+} SxCashflowCount;
+
+typedef struct
+{
+    GPtrArray *todo; /* <SxCashflowCount*> */
+    guint first;
+    guint last;
     const GDate *range_start;
     const GDate *range_end;
-} SxAllCashflow;
+} SxCashflowChunk;
 
-static void instantiate_cashflow_cb(gpointer data, gpointer _user_data)
+static gpointer
+count_occurrences_thread(gpointer user_data)
 {
-    const SchedXaction* sx = (const SchedXaction*) data;
-    SxAllCashflow* userdata = (SxAllCashflow*) _user_data;
-    gint count;
+    SxCashflowChunk *chunk = user_data;
+    guint i;
+
+    for (i = chunk->first; i < chunk->last; i++)
+    {
+        SxCashflowCount *sx_count = g_ptr_array_index(chunk->todo, i);
+        /* How often does this particular SX occur in the date range? */
+        sx_count->count = gnc_sx_get_num_occur_daterange(sx_count->sx,
+                                                         chunk->range_start,
+                                                         chunk->range_end);
+    }
+    return NULL;
+}
+
+static void
+count_occurrences(GPtrArray *todo,
+                  const GDate *range_start, const GDate *range_end)
+{
+    SxCashflowChunk *chunks;
+    GThread **threads;
+    guint n_threads, per_thread, i;
 
-    g_assert(sx);
-    g_assert(userdata);
+    n_threads = MIN((guint)g_get_num_processors(),
+                    todo->len / CASHFLOW_MIN_SX_PER_THREAD);
+    n_threads = MAX(n_threads, 1);
+    per_thread = (todo->len + n_threads - 1) / n_threads;
 
-    /* How often does this particular SX occur in the date range? */
-    count = gnc_sx_get_num_occur_daterange(sx, userdata->range_start,
-                                           userdata->range_end);
-    if (count > 0)
+    chunks = g_new0(SxCashflowChunk, n_threads);
+    threads = g_new0(GThread*, n_threads);
+    for (i = 0; i < n_threads; i++)
     {
-        /* If it occurs at least once, calculate ("instantiate") its
-         * cash flow and add it to the result
-         * g_hash<GUID,gnc_numeric> */
-        instantiate_cashflow_internal(sx,
-                                      userdata->hash,
-                                      userdata->creation_errors,
-                                      count);
+        chunks[i].todo = todo;
+        chunks[i].first = MIN(i * per_thread, todo->len);
+        chunks[i].last = MIN(chunks[i].first + per_thread, todo->len);
+        chunks[i].range_start = range_start;
+        chunks[i].range_end = range_end;
     }
+
+    /* The calling thread takes the first chunk itself. */
+    for (i = 1; i < n_threads; i++)
+        threads[i] = g_thread_new("sx-cashflow", count_occurrences_thread,
+                                  &chunks[i]);
+    count_occurrences_thread(&chunks[0]);
+    for (i = 1; i < n_threads; i++)
+        g_thread_join(threads[i]);
+
+    g_debug("counted the occurrences of %u SXes (%u threads)",
+            todo->len, n_threads);
+
+    g_free(threads);
+    g_free(chunks);
 }
 
 void gnc_sx_all_instantiate_cashflow(GList *all_sxes,
                                      const GDate *range_start, const GDate *range_end,
                                      GHashTable* map, GList **creation_errors)
 {
-    SxAllCashflow userdata;
-    userdata.hash = map;
-    userdata.creation_errors = creation_errors;
-    userdata.range_start = range_start;
-    userdata.range_end = range_end;
+    guint n_sxes = g_list_length(all_sxes);
+    SxCashflowCount *counts = g_new0(SxCashflowCount, n_sxes);
+    GPtrArray *todo = g_ptr_array_new();
+    gint64 range_key = 0;
+    gboolean cache_counts;
+    GList *iter;
+    guint i;
+
+    g_assert(range_start);
+    g_assert(range_end);
+
+    if (cashflow_event_handler_id == 0)
+        cashflow_event_handler_id =
+            qof_event_register_handler(_cashflow_event_handler, NULL);
+
+    cache_counts = _cashflow_range_key(range_start, range_end, &range_key);
+    for (iter = all_sxes, i = 0; iter != NULL; iter = iter->next, i++)
+    {
+        SxCashflowCount *sx_count = &counts[i];
+        gpointer count;
+
+        sx_count->sx = (const SchedXaction*)iter->data;
+        g_assert(sx_count->sx);
+        sx_count->cache = _get_cashflow_cache(sx_count->sx);
+        if (cache_counts &&
+            g_hash_table_lookup_extended(sx_count->cache->counts, &range_key,
+                                         NULL, &count))
+        {
+            sx_count->count = GPOINTER_TO_INT(count);
+            sx_count->count_known = TRUE;
+        }
+        else
+            g_ptr_array_add(todo, sx_count);
+    }
+
+    if (todo->len > 0)
+        count_occurrences(todo, range_start, range_end);
+
+    for (i = 0; i < n_sxes; i++)
+    {
+        SxCashflowCount *sx_count = &counts[i];
+
+        if (!sx_count->count_known && cache_counts)
+        {
+            GHashTable *cached = sx_count->cache->counts;
+            if (g_hash_table_size(cached) >= CASHFLOW_MAX_CACHED_RANGES)
+                g_hash_table_remove_all(cached);
+            g_hash_table_insert(cached, g_memdup(&range_key, sizeof(range_key)),
+                                GINT_TO_POINTER(sx_count->count));
+        }
+
+        /* If it occurs at least once, calculate ("instantiate") its
+         * cash flow and add it to the result
+         * g_hash<GUID,gnc_numeric> */
+        if (sx_count->count > 0)
+            instantiate_cashflow_internal(sx_count->sx, sx_count->cache,
+                                          map, creation_errors,
+                                          sx_count->count);
+    }
 
-    /* The work is done in the callback for each SX */
-    g_list_foreach(all_sxes, instantiate_cashflow_cb, &userdata);
+    g_ptr_array_free(todo, TRUE);
+    g_free(counts);
 }
 
 
@@ -48,6 +48,10 @@ typedef struct _GncSxInstanceModel
 
     /* private */
     gint qof_event_handler_id;
+    /* The SX whose "updated" signal is being emitted, and whether one
+     * of the handlers has already regenerated its instances. */
+    SchedXaction *updating_sx;
+    gboolean updating_sx_done;
 
     /* signals */
     /* void (*added)(SchedXaction *sx); // gpointer user_data */
@@ -131,11 +135,23 @@ GncSxInstanceModel* gnc_sx_get_instances(const GDate *range_end, gboolean includ
  * Regenerates and updates the GncSxInstances* for the given SX.  Model
  * consumers are probably going to call this in response to seeing the
  * "update" signal, unless they need to be doing something else like
- * finishing an iteration over an existing GncSxInstances*.
+ * finishing an iteration over an existing GncSxInstances*.  While the
+ * "updated" signal is being emitted only the first call regenerates
+ * the SX, so every handler can make it.
  **/
 void gnc_sx_instance_model_update_sx_instances(GncSxInstanceModel *model, SchedXaction *sx);
 void gnc_sx_instance_model_remove_sx_instances(GncSxInstanceModel *model, SchedXaction *sx);
 
+/**
+ * Moves the end of the model's range to range_end.  When the range
+ * grows only the instances past the old end are generated, and the
+ * reminders that now fall inside the creation window become to-create;
+ * when it shrinks each SX is regenerated.  "updated" is emitted for
+ * each SX whose instances changed, with the instances already brought
+ * up to date.
+ **/
+void gnc_sx_instance_model_set_range_end(GncSxInstanceModel *model, const GDate *range_end);
+
 /** Fix up numerics where they've gotten out-of-sync with the formulas.
  *
  * Ideally this would be done at load time, but it requires gnc_exp_parser to
@@ -242,7 +258,11 @@ GHashTable* gnc_g_hash_new_guid_numeric(void);
  *
  * The creation_errors list, if non-NULL, receive any errors that
  * occurred during creation, similar as in
- * gnc_sx_instance_model_effect_change(). */
+ * gnc_sx_instance_model_effect_change().
+ *
+ * The occurrence counts and the single-occurrence amounts of each SX
+ * are cached with the SX until the book changes, and the counts that
+ * are not cached are computed on worker threads. */
 void gnc_sx_all_instantiate_cashflow(GList *all_sxes,
                                      const GDate *range_start, const GDate *range_end,
                                      GHashTable* map, GList **creation_errors);
@@ -1758,84 +1758,199 @@ PrintAmountInternal(char *buf, gnc_numeric val, const GNCPrintAmountInfo *info)
     return strlen(buf);
 }
 
-/**
- * @param bufp Should be at least 64 chars.
- **/
-int
-xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
+/* Amount formatters
+ *
+ * A formatter holds the locale rules xaccSPrintAmount needs for one
+ * print info, looked up once instead of for every amount.  Decimal
+ * amounts are printed by formatting their digits directly; anything
+ * else goes through PrintAmountInternal.  The commodity is not part of
+ * the rules, its symbol is looked up when printing as it may change.
+ */
+typedef struct
 {
-    struct lconv *lc;
-
-    char *orig_bufp = bufp;
-    const char *currency_symbol;
     const char *sign;
-
+    char sign_posn;
     char cs_precedes;
     char sep_by_space;
-    char sign_posn;
+    gboolean print_sign;
+} AmountSignRules;
 
-    gboolean print_sign = TRUE;
-    gboolean print_absolute = FALSE;
+struct GNCAmountFormatter
+{
+    GNCPrintAmountInfo info;
+    AmountSignRules rules[2];   /* [0]: zero or positive, [1]: negative */
+    char separator[8];          /* first character of the separator */
+    char decimal_point[8];      /* first character of the decimal point */
+    /* Whether there's a thousands separator with n whole digits to its
+     * right.  An int64 has at most 19 digits. */
+    gboolean group_after[20];
+    gboolean fast_decimals;
+};
 
-    if (!bufp)
-        return 0;
+/* Formatters by print info for xaccSPrintAmount, the locale
+ * information from gnc_localeconv never changes once read. */
+static GHashTable *amount_formatters = NULL;
+
+static void
+amount_formatter_init (GNCAmountFormatter *fmt, const GNCPrintAmountInfo *info)
+{
+    struct lconv *lc = gnc_localeconv();
+    const char *group;
+    int group_count = 0;
+    int i;
 
-    lc = gnc_localeconv();
-    if (info.use_locale)
-        if (gnc_numeric_negative_p (val))
+    fmt->info = *info;
+    for (i = 0; i < 2; i++)
+    {
+        AmountSignRules *rules = &fmt->rules[i];
+
+        if (info->use_locale)
         {
-            cs_precedes  = lc->n_cs_precedes;
-            sep_by_space = lc->n_sep_by_space;
+            rules->cs_precedes  = i ? lc->n_cs_precedes : lc->p_cs_precedes;
+            rules->sep_by_space = i ? lc->n_sep_by_space : lc->p_sep_by_space;
         }
         else
         {
-            cs_precedes  = lc->p_cs_precedes;
-            sep_by_space = lc->p_sep_by_space;
+            rules->cs_precedes = TRUE;
+            rules->sep_by_space = TRUE;
         }
-    else
-    {
-        cs_precedes = TRUE;
-        sep_by_space = TRUE;
+        rules->sign = i ? lc->negative_sign : lc->positive_sign;
+        rules->sign_posn = i ? lc->n_sign_posn : lc->p_sign_posn;
+        rules->print_sign = (rules->sign != NULL) && (rules->sign[0] != 0);
     }
 
-    if (info.commodity && info.use_symbol)
+    g_utf8_strncpy (fmt->separator, info->monetary ? lc->mon_thousands_sep
+                    : lc->thousands_sep, 1);
+    g_utf8_strncpy (fmt->decimal_point, info->monetary ? lc->mon_decimal_point
+                    : lc->decimal_point, 1);
+
+    /* Walk the grouping the way PrintAmountInternal does, from the
+     * least significant digit up. */
+    group = info->monetary ? lc->mon_grouping : lc->grouping;
+    fmt->group_after[0] = FALSE;
+    for (i = 1; i < G_N_ELEMENTS (fmt->group_after); i++)
     {
-        currency_symbol = gnc_commodity_get_nice_symbol (info.commodity);
-        if (!gnc_commodity_is_iso (info.commodity))
-        {
-            cs_precedes  = FALSE;
-            sep_by_space = TRUE;
-        }
+        fmt->group_after[i] = FALSE;
+        if (*group == CHAR_MAX || ++group_count != *group)
+            continue;
+        fmt->group_after[i] = TRUE;
+        group_count = 0;
+        if (group[1] != '\0')
+            group++;
     }
-    else /* !info.use_symbol || !info.commodity */
-        currency_symbol = "";
 
-    if (gnc_numeric_negative_p (val))
+    /* PrintAmountInternal handles rounding and the odd locale with an
+     * empty separator or decimal point. */
+    fmt->fast_decimals = !(info->force_fit && info->round) &&
+        (!info->use_separators || fmt->separator[0]) &&
+        fmt->decimal_point[0];
+}
+
+/* Print the absolute value of val if it is a decimal number, as
+ * PrintAmountInternal would.  Returns the length of the string printed
+ * or -1 if val has to be printed by PrintAmountInternal. */
+static int
+amount_formatter_print_decimal (const GNCAmountFormatter *fmt, char *buf,
+                                gnc_numeric val)
+{
+    char digits[20];
+    char *bufp = buf, *point;
+    gint64 whole, frac, denom;
+    int n_digits = 0, n_places = 0, min_dp, max_dp;
+
+    if (!fmt->fast_decimals || val.denom <= 0 || val.num == G_MININT64)
+        return -1;
+    while (n_places <= maximum_decimals && pow_10[n_places] != val.denom)
+        n_places++;
+    if (n_places > maximum_decimals)
+        return -1;
+
+    min_dp = fmt->info.min_decimal_places;
+    max_dp = fmt->info.force_fit ? fmt->info.max_decimal_places : 99;
+    if (min_dp > max_dp)
+        return -1;
+
+    whole = ABS (val.num) / val.denom;
+    frac = ABS (val.num) % val.denom;
+
+    do
     {
-        sign = lc->negative_sign;
-        sign_posn = lc->n_sign_posn;
+        digits[n_digits++] = '0' + whole % 10;
+        whole /= 10;
     }
-    else
+    while (whole);
+    while (n_digits--)
     {
-        sign = lc->positive_sign;
-        sign_posn = lc->p_sign_posn;
+        *bufp++ = digits[n_digits];
+        if (fmt->info.use_separators && fmt->group_after[n_digits])
+            bufp = g_stpcpy (bufp, fmt->separator);
     }
 
-    if (gnc_numeric_zero_p (val) || (sign == NULL) || (sign[0] == 0))
-        print_sign = FALSE;
+    point = bufp;
+    bufp = g_stpcpy (bufp, fmt->decimal_point);
+    denom = val.denom;
+    n_places = 0;
+    while (frac != 0 && denom != 1 && n_places < max_dp)
+    {
+        denom /= 10;
+        *bufp++ = '0' + frac / denom;
+        frac %= denom;
+        n_places++;
+    }
+    for (; n_places < min_dp; n_places++)
+        *bufp++ = '0';
+    for (; n_places > min_dp && bufp[-1] == '0'; n_places--)
+        bufp--;
+    if (n_places == 0)
+        bufp = point;
+    *bufp = '\0';
+
+    return bufp - buf;
+}
+
+static int
+amount_formatter_print (const GNCAmountFormatter *fmt,
+                        const GNCPrintAmountInfo *info,
+                        char *bufp, gnc_numeric val)
+{
+    char *orig_bufp = bufp;
+    const char *currency_symbol;
+    const AmountSignRules *rules;
+    char cs_precedes, sep_by_space, sign_posn;
+    gboolean print_sign;
+    gboolean print_absolute = FALSE;
+    int len;
+
+    rules = &fmt->rules[gnc_numeric_negative_p (val) ? 1 : 0];
+    cs_precedes = rules->cs_precedes;
+    sep_by_space = rules->sep_by_space;
+    sign_posn = rules->sign_posn;
+    print_sign = rules->print_sign && !gnc_numeric_zero_p (val);
+
+    if (info->commodity && info->use_symbol)
+    {
+        currency_symbol = gnc_commodity_get_nice_symbol (info->commodity);
+        if (!gnc_commodity_is_iso (info->commodity))
+        {
+            cs_precedes  = FALSE;
+            sep_by_space = TRUE;
+        }
+    }
+    else /* !info->use_symbol || !info->commodity */
+        currency_symbol = "";
 
     /* See if we print sign now */
     if (print_sign && (sign_posn == 1))
-        bufp = g_stpcpy(bufp, sign);
+        bufp = g_stpcpy(bufp, rules->sign);
 
     /* Now see if we print currency */
     if (cs_precedes)
     {
         /* See if we print sign now */
         if (print_sign && (sign_posn == 3))
-            bufp = g_stpcpy(bufp, sign);
+            bufp = g_stpcpy(bufp, rules->sign);
 
-        if (info.use_symbol)
+        if (info->use_symbol)
         {
             bufp = g_stpcpy(bufp, currency_symbol);
             if (sep_by_space)
@@ -1844,7 +1959,7 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
 
         /* See if we print sign now */
         if (print_sign && (sign_posn == 4))
-            bufp = g_stpcpy(bufp, sign);
+            bufp = g_stpcpy(bufp, rules->sign);
     }
 
     /* Now see if we print parentheses */
@@ -1855,9 +1970,12 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
     }
 
     /* Now print the value */
-    bufp += PrintAmountInternal(bufp,
-                                print_absolute ? gnc_numeric_abs(val) : val,
-                                &info);
+    if (print_absolute)
+        val = gnc_numeric_abs (val);
+    len = amount_formatter_print_decimal (fmt, bufp, val);
+    if (len < 0)
+        len = PrintAmountInternal(bufp, val, info);
+    bufp += len;
 
     /* Now see if we print parentheses */
     if (print_sign && (sign_posn == 0))
@@ -1868,9 +1986,9 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
     {
         /* See if we print sign now */
         if (print_sign && (sign_posn == 3))
-            bufp = g_stpcpy(bufp, sign);
+            bufp = g_stpcpy(bufp, rules->sign);
 
-        if (info.use_symbol)
+        if (info->use_symbol)
         {
             if (sep_by_space)
                 bufp = g_stpcpy(bufp, " ");
@@ -1879,17 +1997,112 @@ xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
 
         /* See if we print sign now */
         if (print_sign && (sign_posn == 4))
-            bufp = g_stpcpy(bufp, sign);
+            bufp = g_stpcpy(bufp, rules->sign);
     }
 
     /* See if we print sign now */
     if (print_sign && (sign_posn == 2))
-        bufp = g_stpcpy(bufp, sign);
+        bufp = g_stpcpy(bufp, rules->sign);
 
     /* return length of printed string */
     return (bufp - orig_bufp);
 }
 
+GNCAmountFormatter *
+gnc_amount_formatter_new (GNCPrintAmountInfo info)
+{
+    GNCAmountFormatter *fmt = g_new (GNCAmountFormatter, 1);
+
+    amount_formatter_init (fmt, &info);
+    return fmt;
+}
+
+void
+gnc_amount_formatter_free (GNCAmountFormatter *fmt)
+{
+    g_free (fmt);
+}
+
+int
+gnc_amount_formatter_print (const GNCAmountFormatter *fmt, char *bufp,
+                            gnc_numeric val)
+{
+    if (!fmt || !bufp)
+        return 0;
+
+    return amount_formatter_print (fmt, &fmt->info, bufp, val);
+}
+
+gchar *
+gnc_amount_formatter_print_array (const GNCAmountFormatter *fmt,
+                                  const gnc_numeric *vals, guint n_vals,
+                                  const char **strings)
+{
+    GString *str;
+    gsize *offsets;
+    char buf[1024];
+    guint i;
+
+    g_return_val_if_fail (fmt && (vals || !n_vals) && strings, NULL);
+
+    str = g_string_sized_new (n_vals * 16);
+    offsets = g_new (gsize, n_vals);
+    for (i = 0; i < n_vals; i++)
+    {
+        int len = amount_formatter_print (fmt, &fmt->info, buf, vals[i]);
+
+        offsets[i] = str->len;
+        g_string_append_len (str, buf, len + 1);
+    }
+    for (i = 0; i < n_vals; i++)
+        strings[i] = str->str + offsets[i];
+    g_free (offsets);
+
+    return g_string_free (str, FALSE);
+}
+
+/* Return the formatter xaccSPrintAmount uses for info. */
+static const GNCAmountFormatter *
+amount_formatter_lookup (const GNCPrintAmountInfo *info)
+{
+    GNCAmountFormatter *fmt;
+    guint key = info->max_decimal_places |
+        info->min_decimal_places << 8 |
+        info->use_separators << 16 |
+        info->use_symbol << 17 |
+        info->use_locale << 18 |
+        info->monetary << 19 |
+        info->force_fit << 20 |
+        info->round << 21;
+
+    if (!amount_formatters)
+        amount_formatters = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                                   NULL, g_free);
+
+    fmt = g_hash_table_lookup (amount_formatters, GUINT_TO_POINTER (key));
+    if (!fmt)
+    {
+        fmt = g_new (GNCAmountFormatter, 1);
+        amount_formatter_init (fmt, info);
+        fmt->info.commodity = NULL;
+        g_hash_table_insert (amount_formatters, GUINT_TO_POINTER (key), fmt);
+    }
+    return fmt;
+}
+
+/**
+ * @param bufp Should be at least 64 chars.
+ **/
+int
+xaccSPrintAmount (char * bufp, gnc_numeric val, GNCPrintAmountInfo info)
+{
+    if (!bufp)
+        return 0;
+
+    return amount_formatter_print (amount_formatter_lookup (&info), &info,
+                                   bufp, val);
+}
+
 const char *
 xaccPrintAmount (gnc_numeric val, GNCPrintAmountInfo info)
 {
@@ -315,6 +315,29 @@ GNCPrintAmountInfo gnc_integral_print_info (void);
 const char * xaccPrintAmount (gnc_numeric val, GNCPrintAmountInfo info);
 int xaccSPrintAmount (char *buf, gnc_numeric val, GNCPrintAmountInfo info);
 
+/* An amount formatter prints amounts like xaccSPrintAmount does for
+ *    one print info, with the locale rules looked up once when it is
+ *    created.  xaccSPrintAmount keeps formatters for the print infos
+ *    it is called with, use one directly to format many amounts.
+ *
+ * gnc_amount_formatter_print() prints val to buf, which like the
+ *    buffer of xaccSPrintAmount should be at least 64 chars, and
+ *    returns the length of the printed string.
+ *
+ * gnc_amount_formatter_print_array() prints n_vals amounts into one
+ *    newly allocated block, which it returns, and points strings[i]
+ *    to the string printed for vals[i].  Free the block with g_free.
+ */
+typedef struct GNCAmountFormatter GNCAmountFormatter;
+
+GNCAmountFormatter *gnc_amount_formatter_new (GNCPrintAmountInfo info);
+void gnc_amount_formatter_free (GNCAmountFormatter *fmt);
+int gnc_amount_formatter_print (const GNCAmountFormatter *fmt, char *bufp,
+                                gnc_numeric val);
+gchar *gnc_amount_formatter_print_array (const GNCAmountFormatter *fmt,
+                                         const gnc_numeric *vals, guint n_vals,
+                                         const char **strings);
+
 const gchar *printable_value(gdouble val, gint denom);
 gchar *number_to_words(gdouble val, gint64 denom);
 gchar *numeric_to_words(gnc_numeric val);
@@ -132,6 +132,27 @@ run_parser_test (TestNode *node)
         }
     }
 
+    /* A compiled expression must agree with the parser. */
+    {
+        GncCompiledExp *compiled = gnc_exp_parser_compile (node->exp);
+        if (compiled && gnc_exp_parser_compiled_num_vars (compiled) == 0)
+        {
+            gnc_numeric compiled_result = gnc_numeric_error (-1);
+            gboolean compiled_ok =
+                gnc_exp_parser_compiled_eval (compiled, NULL, &compiled_result);
+            gnc_exp_parser_compiled_free (compiled);
+            if (compiled_ok != succeeded ||
+                (succeeded && !gnc_numeric_equal (compiled_result, result)))
+            {
+                failure_args (node->test_name, node->file, node->line,
+                              "compiled expression disagrees");
+                return;
+            }
+        }
+        else
+            gnc_exp_parser_compiled_free (compiled);
+    }
+
     success (node->test_name);
 }
 
@@ -246,12 +267,86 @@ test_variable_expressions()
     success("variable found");
 }
 
+static void
+test_compiled_expression (const char *exp, gnc_numeric x, gnc_numeric y)
+{
+    GncCompiledExp *compiled = gnc_exp_parser_compile (exp);
+    GHashTable *vars = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              g_free, g_free);
+    gnc_numeric parsed = gnc_numeric_error (-1);
+    gnc_numeric evaluated = gnc_numeric_error (-2);
+    gchar *errLoc = NULL;
+    gboolean parsed_ok, evaluated_ok;
+
+    g_hash_table_insert (vars, g_strdup ("x"), g_memdup (&x, sizeof (x)));
+    g_hash_table_insert (vars, g_strdup ("y"), g_memdup (&y, sizeof (y)));
+    do_test (compiled != NULL, exp);
+    evaluated_ok = gnc_exp_parser_compiled_eval_vars (compiled, vars, &evaluated);
+    parsed_ok = gnc_exp_parser_parse_separate_vars (exp, &parsed, &errLoc, vars);
+    do_test (parsed_ok == evaluated_ok, "compiled expression succeeds like the parser");
+    do_test (!parsed_ok || gnc_numeric_equal (parsed, evaluated),
+             "compiled expression evaluates like the parser");
+
+    gnc_exp_parser_compiled_free (compiled);
+    g_hash_table_destroy (vars);
+}
+
+static void
+test_compiled_expressions (void)
+{
+    GncCompiledExp *compiled;
+    gnc_numeric values[4], results[2];
+    gnc_numeric five = gnc_numeric_create (5, 1);
+    gnc_numeric third = gnc_numeric_create (1, 3);
+
+    compiled = gnc_exp_parser_compile ("a * 2 + b");
+    do_test (compiled != NULL, "compiled");
+    do_test (gnc_exp_parser_compiled_num_vars (compiled) == 2, "two variables");
+    do_test (g_strcmp0 (gnc_exp_parser_compiled_var_name (compiled, 0), "a") == 0,
+             "a comes first");
+    do_test (g_strcmp0 (gnc_exp_parser_compiled_var_name (compiled, 1), "b") == 0,
+             "b comes second");
+    values[0] = gnc_numeric_create (3, 1);
+    values[1] = gnc_numeric_create (4, 1);
+    do_test (gnc_exp_parser_compiled_eval (compiled, values, &results[0]) &&
+             gnc_numeric_equal (results[0], gnc_numeric_create (10, 1)),
+             "a * 2 + b with a = 3, b = 4");
+    gnc_exp_parser_compiled_free (compiled);
+
+    compiled = gnc_exp_parser_compile ("a / b");
+    values[0] = gnc_numeric_create (1, 1);
+    values[1] = gnc_numeric_create (2, 1);
+    values[2] = gnc_numeric_create (3, 1);
+    values[3] = gnc_numeric_zero ();
+    do_test (!gnc_exp_parser_compiled_eval_batch (compiled, values, 2, results),
+             "batch with a division by zero fails");
+    do_test (gnc_numeric_equal (results[0], gnc_numeric_create (1, 2)),
+             "first set evaluated");
+    do_test (gnc_numeric_check (results[1]) != GNC_ERROR_OK,
+             "second set is an error");
+    gnc_exp_parser_compiled_free (compiled);
+
+    do_test (gnc_exp_parser_compile ("a = 1") == NULL, "assignments are not compiled");
+    do_test (gnc_exp_parser_compile ("a += 1") == NULL, "assignments are not compiled");
+    do_test (gnc_exp_parser_compile ("plus(1 : 2)") == NULL, "functions are not compiled");
+    do_test (gnc_exp_parser_compile ("1 +") == NULL, "errors are not compiled");
+
+    /* The parser negates variables in place. */
+    test_compiled_expression ("-x + x", five, third);
+    test_compiled_expression ("x * 2 + -x", five, third);
+    test_compiled_expression ("(x - y) * -(y + 1) / x", five, third);
+    test_compiled_expression ("(12.5) + x * z", five, third);
+    test_compiled_expression ("x / (y - y)", five, third);
+    success ("compiled expressions");
+}
+
 static void
 real_main (void *closure, int argc, char **argv)
 {
     /* set_should_print_success (TRUE); */
     test_parser();
     test_variable_expressions();
+    test_compiled_expressions();
     print_test_results();
     exit(get_rv());
 }
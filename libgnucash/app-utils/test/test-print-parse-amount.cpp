@@ -26,6 +26,7 @@ extern "C"
 #include <glib/gprintf.h>
 
 #include "gnc-ui-util.h"
+#include "gnc-locale-utils.h"
 #include "gnc-numeric.h"
 #include "test-engine-stuff.h"
 #include "test-stuff.h"
@@ -54,6 +55,21 @@ test_num_print_info (gnc_numeric n, GNCPrintAmountInfo print_info, int line)
                   "start: %s, string %s, finish: %s (line %d)",
                   gnc_numeric_to_string (n), s,
                   gnc_numeric_to_string (n_parsed), line);
+
+    /* A formatter prints the same, also for the negated amount. */
+    gnc_numeric vals[2] = { n, gnc_numeric_neg (n) };
+    const char *strings[2];
+    auto fmt = gnc_amount_formatter_new (print_info);
+    auto block = gnc_amount_formatter_print_array (fmt, vals, 2, strings);
+    do_test_args (g_strcmp0 (strings[0], s) == 0, "formatter differs",
+                  __FILE__, __LINE__, "xaccPrintAmount %s, formatter %s (line %d)",
+                  s, strings[0], line);
+    do_test_args (g_strcmp0 (strings[1], xaccPrintAmount (vals[1], print_info)) == 0,
+                  "formatter differs", __FILE__, __LINE__,
+                  "negated %s, formatter %s (line %d)",
+                  gnc_numeric_to_string (vals[1]), strings[1], line);
+    g_free (block);
+    gnc_amount_formatter_free (fmt);
 }
 
 static void
@@ -108,6 +124,42 @@ test_num (gnc_numeric n)
     }
 }
 
+/* In a locale that puts negative amounts in parentheses the amount
+ * inside them is printed as if it were positive. */
+static void
+test_parentheses (void)
+{
+    struct lconv *lc = gnc_localeconv ();
+    auto negative_sign = lc->negative_sign;
+    auto n_sign_posn = lc->n_sign_posn;
+    GNCPrintAmountInfo print_info;
+    char buf[64];
+
+    print_info.commodity = NULL;
+    print_info.max_decimal_places = 2;
+    print_info.min_decimal_places = 0;
+    print_info.use_separators = 1;
+    print_info.use_symbol = 0;
+    print_info.use_locale = 1;
+    print_info.monetary = 1;
+    print_info.force_fit = 0;
+    print_info.round = 0;
+
+    lc->negative_sign = const_cast<char*>("-");
+    lc->n_sign_posn = 0;
+    auto fmt = gnc_amount_formatter_new (print_info);
+    lc->negative_sign = negative_sign;
+    lc->n_sign_posn = n_sign_posn;
+
+    gnc_amount_formatter_print (fmt, buf, gnc_numeric_create (-7, 3));
+    do_test_args (g_strcmp0 (buf, "(2 + 1/3)") == 0, "parentheses fraction",
+                  __FILE__, __LINE__, "-7/3 printed as %s", buf);
+    gnc_amount_formatter_print (fmt, buf, gnc_numeric_create (-1234, 100));
+    do_test_args (g_strcmp0 (buf, "(12.34)") == 0, "parentheses decimal",
+                  __FILE__, __LINE__, "-12.34 printed as %s", buf);
+    gnc_amount_formatter_free (fmt);
+}
+
 #define IS_VALID_NUM(n,m)                                               \
     if (gnc_numeric_check(n)) {                                         \
         do_test_args(gnc_numeric_check(n) == GNC_ERROR_OVERFLOW,        \
@@ -157,6 +209,8 @@ run_tests (void)
     }
     g_log_remove_handler (log_domain, hdlr);
     test_clear_error_list();
+
+    test_parentheses ();
 }
 
 int
@@ -24,6 +24,7 @@ extern "C"
 #include <stdlib.h>
 #include <glib.h>
 #include "SX-book.h"
+#include "SchedXaction.h"
 #include "gnc-date.h"
 #include "gnc-sx-instance-model.h"
 #include "gnc-ui-util.h"
@@ -213,6 +214,116 @@ test_state_changes()
     remove_sx(foo);
 }
 
+static void
+test_range_end()
+{
+    SchedXaction *foo;
+    GDate start, end, later;
+    GncSxInstanceModel *model, *fresh;
+    GncSxInstances *insts, *fresh_insts;
+    GList *iter, *fresh_iter;
+
+    g_date_clear(&start, 1);
+    gnc_gdate_set_today (&start);
+    end = start;
+    g_date_add_days(&end, 3);
+    later = start;
+    g_date_add_days(&later, 40);
+
+    foo = add_daily_sx("foo", &start, NULL, NULL);
+    model = gnc_sx_get_instances(&end, TRUE);
+    insts = (GncSxInstances*)model->sx_instance_list->data;
+    do_test(g_list_length(insts->instance_list) == 4, "4 instances");
+
+    gnc_sx_instance_model_set_range_end(model, &later);
+    fresh = gnc_sx_get_instances(&later, TRUE);
+    fresh_insts = (GncSxInstances*)fresh->sx_instance_list->data;
+    do_test(g_list_length(insts->instance_list) == g_list_length(fresh_insts->instance_list),
+            "extended like a fresh model");
+    for (iter = insts->instance_list, fresh_iter = fresh_insts->instance_list;
+         iter != NULL && fresh_iter != NULL;
+         iter = iter->next, fresh_iter = fresh_iter->next)
+    {
+        GncSxInstance *inst = (GncSxInstance*)iter->data;
+        GncSxInstance *fresh_inst = (GncSxInstance*)fresh_iter->data;
+        do_test(g_date_compare(&inst->date, &fresh_inst->date) == 0, "same date");
+        do_test(inst->state == fresh_inst->state, "same state");
+        do_test(inst->parent == insts, "same parent");
+    }
+    g_object_unref(fresh);
+
+    gnc_sx_instance_model_set_range_end(model, &end);
+    do_test(g_list_length(insts->instance_list) == 4, "shrunk back to 4 instances");
+
+    g_object_unref(model);
+    remove_sx(foo);
+}
+
+static void
+count_updated(GncSxInstanceModel *model, SchedXaction *sx, gpointer user_data)
+{
+    /* Handlers call this; it must not regenerate the instances again. */
+    gnc_sx_instance_model_update_sx_instances(model, sx);
+    ++*(int*)user_data;
+}
+
+static void
+test_range_end_reminders()
+{
+    SchedXaction *foo;
+    GDate start, end, later, first_reminder;
+    GncSxInstanceModel *model;
+    GncSxInstances *insts;
+    GncSxInstance *inst = NULL;
+    GList *iter;
+    int updates = 0;
+
+    g_date_clear(&start, 1);
+    gnc_gdate_set_today (&start);
+    end = start;
+    g_date_add_days(&end, 3);
+    later = start;
+    g_date_add_days(&later, 6);
+    first_reminder = end;
+    g_date_add_days(&first_reminder, 1);
+
+    foo = add_daily_sx("foo", &start, NULL, NULL);
+    xaccSchedXactionSetAdvanceReminder(foo, 5);
+    model = gnc_sx_get_instances(&end, TRUE);
+    g_signal_connect(model, "updated", (GCallback)count_updated, &updates);
+    insts = (GncSxInstances*)model->sx_instance_list->data;
+    do_test(g_list_length(insts->instance_list) == 9, "4 to create and 5 reminders");
+    for (iter = insts->instance_list; iter != NULL; iter = iter->next)
+    {
+        inst = (GncSxInstance*)iter->data;
+        if (g_date_compare(&inst->date, &first_reminder) == 0)
+            break;
+    }
+    do_test(iter != NULL && inst->state == SX_INSTANCE_STATE_REMINDER,
+            "the day after the range end is a reminder");
+
+    gnc_sx_instance_model_set_range_end(model, &later);
+    do_test(updates == 1, "updated emitted once");
+    do_test(inst->state == SX_INSTANCE_STATE_TO_CREATE
+            && inst->orig_state == SX_INSTANCE_STATE_TO_CREATE,
+            "the reminder moved into the range is to be created");
+    do_test(g_list_length(insts->instance_list) == 12, "7 to create and 5 reminders");
+    for (iter = insts->instance_list; iter != NULL; iter = iter->next)
+    {
+        GncSxInstance *each = (GncSxInstance*)iter->data;
+        do_test(each->state == (g_date_compare(&each->date, &later) <= 0
+                                ? SX_INSTANCE_STATE_TO_CREATE
+                                : SX_INSTANCE_STATE_REMINDER),
+                "to create up to the range end, reminders after it");
+    }
+
+    gnc_sx_instance_model_set_range_end(model, &later);
+    do_test(updates == 1, "nothing emitted for the same range end");
+
+    g_object_unref(model);
+    remove_sx(foo);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -228,6 +339,8 @@ main(int argc, char **argv)
     }
     test_basic();
     test_state_changes();
+    test_range_end();
+    test_range_end_reminders();
 
     print_test_results();
     exit(get_rv());
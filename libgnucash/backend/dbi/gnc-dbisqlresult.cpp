@@ -101,26 +101,53 @@ GncDbiSqlResult::IteratorImpl::operator++()
     return m_inst->m_sentinel;
 }
 
+unsigned int
+GncDbiSqlResult::column_index (const char* col) const noexcept
+{
+    if (m_columns.empty())
+    {
+        auto nfields = dbi_result_get_numfields (m_dbi_result);
+        if (nfields == DBI_FIELD_ERROR)
+            return 0;
+        m_columns.reserve (nfields);
+        for (unsigned int idx = 1; idx <= nfields; ++idx)
+        {
+            ColumnInfo info{dbi_result_get_field_name (m_dbi_result, idx),
+                    dbi_result_get_field_type_idx (m_dbi_result, idx),
+                    dbi_result_get_field_attribs_idx (m_dbi_result, idx)};
+            m_columns.push_back (info);
+            if (info.name != nullptr)
+                m_column_index.emplace (info.name, idx);
+        }
+    }
+    auto iter = m_column_index.find (col);
+    if (iter != m_column_index.end())
+        return iter->second;
+    /* libdbi also accepts qualified names like "table.field". */
+    auto idx = dbi_result_get_field_idx (m_dbi_result, col);
+    return idx <= m_columns.size() ? idx : 0;
+}
+
 int64_t
 GncDbiSqlResult::IteratorImpl::get_int_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_INTEGER)
+    auto idx = m_inst->column_index (col);
+    if(idx == 0 || m_inst->column_info(idx).type != DBI_TYPE_INTEGER)
         throw (std::invalid_argument{"Requested integer from non-integer column."});
-    return dbi_result_get_longlong (m_inst->m_dbi_result, col);
+    return dbi_result_get_longlong_idx (m_inst->m_dbi_result, idx);
 }
 
 double
 GncDbiSqlResult::IteratorImpl::get_float_at_col(const char* col) const
 {
     constexpr double float_precision = 1000000.0;
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    auto attrs = dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_DECIMAL ||
-       (attrs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE4)
+    auto idx = m_inst->column_index (col);
+    if(idx == 0 ||
+       m_inst->column_info(idx).type != DBI_TYPE_DECIMAL ||
+       (m_inst->column_info(idx).attribs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE4)
         throw (std::invalid_argument{"Requested float from non-float column."});
     auto locale = gnc_push_locale (LC_NUMERIC, "C");
-    auto interim =  dbi_result_get_float(m_inst->m_dbi_result, col);
+    auto interim =  dbi_result_get_float_idx(m_inst->m_dbi_result, idx);
     gnc_pop_locale (LC_NUMERIC, locale);
     double retval = static_cast<double>(round(interim * float_precision)) / float_precision;
     return retval;
@@ -129,13 +156,13 @@ GncDbiSqlResult::IteratorImpl::get_float_at_col(const char* col) const
 double
 GncDbiSqlResult::IteratorImpl::get_double_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    auto attrs = dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_DECIMAL ||
-       (attrs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE8)
+    auto idx = m_inst->column_index (col);
+    if(idx == 0 ||
+       m_inst->column_info(idx).type != DBI_TYPE_DECIMAL ||
+       (m_inst->column_info(idx).attribs & DBI_DECIMAL_SIZEMASK) != DBI_DECIMAL_SIZE8)
         throw (std::invalid_argument{"Requested double from non-double column."});
     auto locale = gnc_push_locale (LC_NUMERIC, "C");
-    auto retval =  dbi_result_get_double(m_inst->m_dbi_result, col);
+    auto retval =  dbi_result_get_double_idx(m_inst->m_dbi_result, idx);
     gnc_pop_locale (LC_NUMERIC, locale);
     return retval;
 }
@@ -143,31 +170,35 @@ GncDbiSqlResult::IteratorImpl::get_double_at_col(const char* col) const
 std::string
 GncDbiSqlResult::IteratorImpl::get_string_at_col(const char* col) const
 {
-    auto type = dbi_result_get_field_type (m_inst->m_dbi_result, col);
-    dbi_result_get_field_attribs (m_inst->m_dbi_result, col);
-    if(type != DBI_TYPE_STRING)
+    return std::string{get_cstring_at_col (col)};
+}
+
+const char*
+GncDbiSqlResult::IteratorImpl::get_cstring_at_col(const char* col) const
+{
+    auto idx = m_inst->column_index (col);
+    if(idx == 0 || m_inst->column_info(idx).type != DBI_TYPE_STRING)
         throw (std::invalid_argument{"Requested string from non-string column."});
-    auto strval = dbi_result_get_string(m_inst->m_dbi_result, col);
+    auto strval = dbi_result_get_string_idx(m_inst->m_dbi_result, idx);
     if (strval == nullptr)
     {
         throw (std::invalid_argument{"Column empty."});
     }
-    auto retval =  std::string{strval};
-    return retval;
+    return strval;
 }
+
 time64
 GncDbiSqlResult::IteratorImpl::get_time64_at_col (const char* col) const
 {
     auto result = (dbi_result_t*) (m_inst->m_dbi_result);
-    auto type = dbi_result_get_field_type (result, col);
-    dbi_result_get_field_attribs (result, col);
-    if (type != DBI_TYPE_DATETIME)
+    auto idx = m_inst->column_index (col);
+    if (idx == 0 || m_inst->column_info(idx).type != DBI_TYPE_DATETIME)
         throw (std::invalid_argument{"Requested time64 from non-time64 column."});
 #if HAVE_LIBDBI_TO_LONGLONG
     /* A less evil hack than the one required by libdbi-0.8, but
      * still necessary to work around the same bug.
      */
-    auto retval = dbi_result_get_as_longlong(result, col);
+    auto retval = dbi_result_get_as_longlong_idx(result, idx);
 #else
     /* A seriously evil hack to work around libdbi bug #15
      * https://sourceforge.net/p/libdbi/bugs/15/. When libdbi
@@ -176,14 +207,22 @@ GncDbiSqlResult::IteratorImpl::get_time64_at_col (const char* col) const
      * Note: 0.9 is available in Debian Jessie and Fedora 21.
      */
     auto row = dbi_result_get_currow (result);
-    auto idx = dbi_result_get_field_idx (result, col) - 1;
-    time64 retval = result->rows[row]->field_values[idx].d_datetime;
+    time64 retval = result->rows[row]->field_values[idx - 1].d_datetime;
 #endif //HAVE_LIBDBI_TO_LONGLONG
     if (retval < MINTIME || retval > MAXTIME)
         retval = 0;
     return retval;
 }
 
+bool
+GncDbiSqlResult::IteratorImpl::is_col_null (const char* col) const noexcept
+{
+    auto idx = m_inst->column_index (col);
+    if (idx == 0)
+        return true;
+    return dbi_result_field_is_null_idx (m_inst->m_dbi_result, idx);
+}
+
 
 /* --------------------------------------------------------- */
 
@@ -27,6 +27,8 @@
 
 #include "gnc-backend-dbi.h"
 #include <gnc-sql-result.hpp>
+#include <cstring>
+#include <unordered_map>
 
 class GncDbiSqlConnection;
 
@@ -57,21 +59,55 @@ protected:
         virtual double get_float_at_col (const char* col) const;
         virtual double get_double_at_col (const char* col) const;
         virtual std::string get_string_at_col (const char* col)const;
+        virtual const char* get_cstring_at_col (const char* col) const;
         virtual time64 get_time64_at_col (const char* col) const;
-        virtual bool is_col_null(const char* col) const noexcept
-        {
-            return dbi_result_field_is_null(m_inst->m_dbi_result, col);
-        }
+        virtual bool is_col_null(const char* col) const noexcept;
     private:
         GncDbiSqlResult* m_inst = nullptr;
     };
 
 private:
+    /**
+     * Type information of a result column, read from libdbi once per result
+     * set. The column's libdbi index is its position in m_columns plus one.
+     */
+    struct ColumnInfo
+    {
+        const char* name;
+        unsigned short type;
+        unsigned int attribs;
+    };
+    struct ColNameHash
+    {
+        size_t operator()(const char* str) const noexcept
+        {
+            size_t hash = 5381;
+            while (*str)
+                hash = hash * 33 + static_cast<unsigned char>(*str++);
+            return hash;
+        }
+    };
+    struct ColNameEqual
+    {
+        bool operator()(const char* a, const char* b) const noexcept
+        {
+            return strcmp (a, b) == 0;
+        }
+    };
+    /** Return the libdbi index of the named column, 0 if there is none. */
+    unsigned int column_index (const char* col) const noexcept;
+    const ColumnInfo& column_info (unsigned int idx) const noexcept
+    {
+        return m_columns[idx - 1];
+    }
     const GncDbiSqlConnection* m_conn = nullptr;
     dbi_result m_dbi_result;
     IteratorImpl m_iter;
     GncSqlRow m_row;
     GncSqlRow m_sentinel;
+    mutable std::vector<ColumnInfo> m_columns;
+    mutable std::unordered_map<const char*, unsigned int, ColNameHash,
+                               ColNameEqual> m_column_index;
 
 };
 
@@ -143,6 +143,18 @@ setup_memory (Fixture* fixture, gconstpointer pData)
     auto guid = qof_instance_get_guid (QOF_INSTANCE (acct1));
     frame->set ({"guid-val"}, new KvpValue (const_cast<GncGUID*> (guid_copy (
             guid))));
+    /* A list nested in a list must come back as an element of its
+     * parent list. */
+    auto inner_frame = new KvpFrame;
+    inner_frame->set ({"inner-string"}, new KvpValue (g_strdup ("qrstuvwxyz")));
+    GList* inner_list = nullptr;
+    inner_list = g_list_append (inner_list, new KvpValue (INT64_C (200)));
+    inner_list = g_list_append (inner_list, new KvpValue (inner_frame));
+    GList* outer_list = nullptr;
+    outer_list = g_list_append (outer_list, new KvpValue (INT64_C (300)));
+    outer_list = g_list_append (outer_list, new KvpValue (inner_list));
+    outer_list = g_list_append (outer_list, new KvpValue (2.71828));
+    frame->set ({"list-val"}, new KvpValue (outer_list));
 
     gnc_account_append_child (root, acct1);
 
@@ -93,9 +93,9 @@ GncSqlColumnTableEntryImpl<CT_ADDRESS>::load (const GncSqlBackend* sql_be,
         auto buf = std::string{m_col_name} + "_" + subtable_row->m_col_name;
         try
         {
-            auto val = row.get_string_at_col (buf.c_str());
+            auto val = row.get_cstring_at_col (buf.c_str());
             auto sub_setter = subtable_row->get_setter(GNC_ID_ADDRESS);
-            set_parameter (addr, val.c_str(), sub_setter,
+            set_parameter (addr, val, sub_setter,
                            subtable_row->m_gobj_param_name);
         }
         catch (std::invalid_argument&)
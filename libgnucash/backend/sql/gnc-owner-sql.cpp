@@ -69,8 +69,8 @@ GncSqlColumnTableEntryImpl<CT_OWNERREF>::load (const GncSqlBackend* sql_be,
     {
         type = static_cast<decltype(type)>(row.get_int_at_col (buf.c_str()));
         buf = std::string{m_col_name} + "_guid";
-        auto val = row.get_string_at_col (buf.c_str());
-        if (string_to_guid (val.c_str(), &guid))
+        auto val = row.get_cstring_at_col (buf.c_str());
+        if (string_to_guid (val, &guid))
             pGuid = &guid;
     }
     catch (std::invalid_argument&)
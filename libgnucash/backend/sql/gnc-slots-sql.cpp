@@ -40,8 +40,11 @@ extern "C"
 #endif
 }
 
+#include <algorithm>
 #include <string>
 #include <sstream>
+#include <memory>
+#include <unordered_map>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -99,10 +102,11 @@ static void set_numeric_val (gpointer pObject, gnc_numeric value);
 static GDate* get_gdate_val (gpointer pObject);
 static void set_gdate_val (gpointer pObject, GDate* value);
 static slot_info_t* slot_info_copy (slot_info_t* pInfo, GncGUID* guid);
-static void slots_load_info (slot_info_t* pInfo);
 
 #define SLOT_MAX_PATHNAME_LEN 4096
 #define SLOT_MAX_STRINGVAL_LEN 4096
+/* Number of guids in the IN list of a query for nested slots. */
+#define SLOT_GUID_BATCH_SIZE 1000
 enum
 {
     id_col = 0,
@@ -186,62 +190,16 @@ GncSqlSlotsBackend::GncSqlSlotsBackend() :
 
 /* ================================================================= */
 
-inline static std::string::size_type
-get_final_delim(std::string& path)
-{
-    auto idx = path.rfind('/');
-    while (idx == path.length())
-    {
-        path.erase(idx);
-        idx = path.rfind('/');
-    }
-    return idx;
-}
-
-static std::string
-get_key (slot_info_t* pInfo)
-{
-    if (!pInfo) return "";
-
-    auto path = pInfo->path;
-    path.erase (0, pInfo->parent_path.size());
-    return path;
-}
-
+/* The loaders build the frames themselves from the rows, so the setters
+ * only hand the value over in pKvpValue.
+ */
 static void
 set_slot_from_value (slot_info_t* pInfo, KvpValue* pValue)
 {
     g_return_if_fail (pInfo != NULL);
     g_return_if_fail (pValue != NULL);
 
-    switch (pInfo->context)
-    {
-    case FRAME:
-    {
-        auto key = get_key (pInfo);
-        pInfo->pKvpFrame->set ({key}, pValue);
-        break;
-    }
-    case LIST:
-    {
-        pInfo->pList = g_list_append (pInfo->pList, pValue);
-        break;
-    }
-    case NONE:
-    default:
-    {
-        auto key = get_key (pInfo);
-        auto path = pInfo->parent_path;
-        auto frame = pInfo->pKvpFrame;
-        if (!path.empty())
-        {
-            frame->set_path ({path, key}, pValue);
-        }
-        else
-            frame->set ({key}, pValue);
-        break;
-    }
-    }
+    pInfo->pKvpValue = pValue;
 }
 
 static  gpointer
@@ -440,60 +398,9 @@ set_guid_val (gpointer pObject,  gpointer pValue)
     g_return_if_fail (pObject != NULL);
     if (pValue == NULL) return;
 
-    switch (pInfo->value_type)
-    {
-    case KvpValue::Type::GUID:
-    {
-        auto new_guid = guid_copy (static_cast<GncGUID*> (pValue));
-        set_slot_from_value (pInfo, new KvpValue {new_guid});
-        break;
-    }
-    case KvpValue::Type::GLIST:
-    {
-        slot_info_t* newInfo = slot_info_copy (pInfo, (GncGUID*)pValue);
-        KvpValue* pValue = NULL;
-        auto key = get_key (pInfo);
-
-        newInfo->context = LIST;
-
-        slots_load_info (newInfo);
-        pValue = new KvpValue {newInfo->pList};
-        pInfo->pKvpFrame->set ({key.c_str()}, pValue);
-	delete newInfo;
-        break;
-    }
-    case KvpValue::Type::FRAME:
-    {
-        slot_info_t* newInfo = slot_info_copy (pInfo, (GncGUID*)pValue) ;
-        auto newFrame = new KvpFrame;
-        newInfo->pKvpFrame = newFrame;
-
-        switch (pInfo->context)
-        {
-        case LIST:
-        {
-            auto value = new KvpValue {newFrame};
-            newInfo->path = get_key (pInfo);
-            pInfo->pList = g_list_append (pInfo->pList, value);
-            break;
-        }
-        case FRAME:
-        default:
-        {
-            auto key = get_key (pInfo);
-            pInfo->pKvpFrame->set ({key.c_str()}, new KvpValue {newFrame});
-            break;
-        }
-        }
-
-        newInfo->context = FRAME;
-        slots_load_info (newInfo);
-        delete newInfo;
-        break;
-    }
-    default:
-        break;
-    }
+    if (pInfo->value_type != KvpValue::Type::GUID) return;
+    auto new_guid = guid_copy (static_cast<GncGUID*> (pValue));
+    set_slot_from_value (pInfo, new KvpValue {new_guid});
 }
 
 static gnc_numeric
@@ -719,129 +626,260 @@ gnc_sql_slots_delete (GncSqlBackend* sql_be, const GncGUID* guid)
     return slot_info.is_ok;
 }
 
-static void
-load_slot (slot_info_t* pInfo, GncSqlRow& row)
+/* Slot rows are loaded in bulk: the rows of all of the objects are read
+ * with one query, ordered by obj_guid so that each object's rows arrive
+ * together, and the rows of nested frames and lists with one query per
+ * nesting level. The frames are then built in memory.
+ */
+struct SlotRow
 {
-    slot_info_t* slot_info;
+    std::string name;
+    KvpValue::Type type;
+    std::unique_ptr<KvpValue> value;    /**< The value of scalar slots */
+    GncGUID child;                      /**< The obj_guid of FRAME and GLIST
+                                           contents */
+};
+using SlotRowVec = std::vector<SlotRow>;
 
-    g_return_if_fail (pInfo != NULL);
-    g_return_if_fail (pInfo->be != NULL);
-    g_return_if_fail (pInfo->pKvpFrame != NULL);
+struct SlotGuidHash
+{
+    size_t operator()(const GncGUID& guid) const noexcept
+    {
+        return guid_hash_to_guint (&guid);
+    }
+};
 
-    slot_info = slot_info_copy (pInfo, NULL);
+struct SlotGuidEqual
+{
+    bool operator()(const GncGUID& a, const GncGUID& b) const noexcept
+    {
+        return guid_equal (&a, &b);
+    }
+};
 
-    gnc_sql_load_object (pInfo->be, row, TABLE_NAME, slot_info, col_table);
+using SlotRowMap = std::unordered_map<GncGUID, SlotRowVec, SlotGuidHash,
+                                      SlotGuidEqual>;
 
-    if (slot_info->pList != pInfo->pList)
+static GncSqlColumnTableEntryPtr
+value_column (KvpValue::Type type)
+{
+    switch (type)
     {
-        if (pInfo->pList != NULL)
-        {
-            PWARN ("Load slot returned a different list than the original");
-        }
-        else
-        {
-            pInfo->pList = slot_info->pList;
-        }
+    case KvpValue::Type::INT64:
+        return col_table[int64_val_col];
+    case KvpValue::Type::STRING:
+        return col_table[string_val_col];
+    case KvpValue::Type::DOUBLE:
+        return col_table[double_val_col];
+    case KvpValue::Type::TIME64:
+        return col_table[time_val_col];
+    case KvpValue::Type::GUID:
+        return col_table[guid_val_col];
+    case KvpValue::Type::NUMERIC:
+        return col_table[numeric_val_col];
+    case KvpValue::Type::GDATE:
+        return col_table[gdate_val_col];
+    default:
+        return nullptr;
     }
-    delete slot_info;
 }
 
-void
-gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst)
+static bool
+load_slot_row (GncSqlBackend* sql_be, GncSqlRow& row, GncGUID& obj_guid,
+               SlotRow& slot)
 {
-    slot_info_t info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
-                         NULL, FRAME, NULL, "" };
-    g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (inst != NULL);
-
-    info.be = sql_be;
-    info.guid = qof_instance_get_guid (inst);
-    info.pKvpFrame = qof_instance_get_slots (inst);
-    info.context = NONE;
+    try
+    {
+        auto guid_str = row.get_cstring_at_col (col_table[obj_guid_col]->name());
+        if (!string_to_guid (guid_str, &obj_guid))
+            return false;
+        slot.name = row.get_cstring_at_col (col_table[name_col]->name());
+        slot.type = static_cast<KvpValue::Type>(
+            row.get_int_at_col (col_table[slot_type_col]->name()));
+        if (slot.type == KvpValue::Type::FRAME ||
+            slot.type == KvpValue::Type::GLIST)
+        {
+            guid_str = row.get_cstring_at_col (col_table[guid_val_col]->name());
+            return string_to_guid (guid_str, &slot.child);
+        }
+    }
+    catch (std::invalid_argument&)
+    {
+        return false;
+    }
 
-    slots_load_info (&info);
+    auto column = value_column (slot.type);
+    if (column == nullptr)
+        return false;
+    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
+                              NULL, FRAME, NULL, "" };
+    slot_info.be = sql_be;
+    slot_info.value_type = slot.type;
+    column->load (sql_be, row, TABLE_NAME, &slot_info);
+    slot.value.reset (slot_info.pKvpValue);
+    return slot.value != nullptr;
 }
 
 static void
-slots_load_info (slot_info_t* pInfo)
+load_slot_rows (GncSqlBackend* sql_be, const std::string& where,
+                SlotRowMap& rows)
 {
-    g_return_if_fail (pInfo != NULL);
-    g_return_if_fail (pInfo->be != NULL);
-    g_return_if_fail (pInfo->guid != NULL);
-    g_return_if_fail (pInfo->pKvpFrame != NULL);
-
-    gnc::GUID guid(*pInfo->guid);
-    std::string sql("SELECT * FROM " TABLE_NAME " WHERE obj_guid='");
-    sql += guid.to_string() + "'";
-    auto stmt = pInfo->be->create_statement_from_sql(sql);
-    if (stmt != nullptr)
+    std::string pkey(obj_guid_col_table[0]->name());
+    std::string sql("SELECT * FROM " TABLE_NAME " WHERE ");
+    sql += where + " ORDER BY " + pkey + ", " + col_table[id_col]->name();
+
+    auto stmt = sql_be->create_statement_from_sql(sql);
+    if (stmt == nullptr)
     {
-        auto result = pInfo->be->execute_select_statement (stmt);
-        for (auto row : *result)
-            load_slot (pInfo, row);
-        delete result;
+        PERR ("stmt == NULL, SQL = '%s'\n", sql.c_str());
+        return;
     }
+    auto result = sql_be->execute_select_statement(stmt);
+    SlotRowVec* obj_rows = nullptr;
+    GncGUID obj_guid = *guid_null(), row_guid;
+    for (auto row : *result)
+    {
+        SlotRow slot;
+        if (!load_slot_row (sql_be, row, row_guid, slot))
+            continue;
+        if (obj_rows == nullptr || !guid_equal (&row_guid, &obj_guid))
+        {
+            obj_guid = row_guid;
+            obj_rows = &rows[obj_guid];
+        }
+        obj_rows->push_back (std::move (slot));
+    }
+    delete result;
 }
 
-static  const GncGUID*
-load_obj_guid (const GncSqlBackend* sql_be, GncSqlRow& row)
+static void
+add_child_guids (const SlotRowMap& rows, const SlotRowMap& loaded,
+                 std::vector<GncGUID>& guids)
 {
-    static GncGUID guid;
-
-    g_return_val_if_fail (sql_be != NULL, NULL);
-
-    gnc_sql_load_object (sql_be, row, NULL, &guid, obj_guid_col_table);
-
-    return &guid;
+    for (auto const& obj : rows)
+        for (auto const& slot : obj.second)
+            if ((slot.type == KvpValue::Type::FRAME ||
+                 slot.type == KvpValue::Type::GLIST) &&
+                loaded.find (slot.child) == loaded.end())
+                guids.push_back (slot.child);
 }
 
+/* Load the rows of the frames and lists nested in rows into nested. */
 static void
-load_slot_for_list_item (GncSqlBackend* sql_be, GncSqlRow& row,
-                         QofCollection* coll)
+load_nested_slot_rows (GncSqlBackend* sql_be, const SlotRowMap& rows,
+                       SlotRowMap& nested)
 {
-    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
-                              NULL, FRAME, NULL, "" };
-    const GncGUID* guid;
-    QofInstance* inst;
-
-    g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (coll != NULL);
-
-    guid = load_obj_guid (sql_be, row);
-    g_assert (guid != NULL);
-    inst = qof_collection_lookup_entity (coll, guid);
+    std::vector<GncGUID> guids;
+    char guid_buf[GUID_ENCODING_LENGTH + 1];
 
-    slot_info.be = sql_be;
-    slot_info.pKvpFrame = qof_instance_get_slots (inst);
-    slot_info.context = NONE;
+    add_child_guids (rows, nested, guids);
+    while (!guids.empty())
+    {
+        SlotRowMap level;
+        for (size_t start = 0; start < guids.size();
+             start += SLOT_GUID_BATCH_SIZE)
+        {
+            std::string where(obj_guid_col_table[0]->name());
+            where += " IN (";
+            auto end = std::min (guids.size(), start + SLOT_GUID_BATCH_SIZE);
+            for (auto idx = start; idx < end; ++idx)
+            {
+                (void)guid_to_string_buff (&guids[idx], guid_buf);
+                if (idx != start)
+                    where += ",";
+                where += "'";
+                where += guid_buf;
+                where += "'";
+            }
+            where += ")";
+            load_slot_rows (sql_be, where, level);
+        }
+        guids.clear();
+        add_child_guids (level, nested, guids);
+        for (auto& obj : level)
+            nested.emplace (obj.first, std::move (obj.second));
+    }
+}
 
-    gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
+static SlotRowVec
+take_slot_rows (SlotRowMap& rows, const GncGUID& guid)
+{
+    auto iter = rows.find (guid);
+    if (iter == rows.end())
+        return SlotRowVec{};
+    auto retval = std::move (iter->second);
+    rows.erase (iter);
+    return retval;
+}
 
+static void build_slot_frame (KvpFrame* frame, const std::string& parent_path,
+                              SlotRowVec& rows, SlotRowMap& nested);
 
+static KvpValue*
+build_slot_value (SlotRow& slot, SlotRowMap& nested)
+{
+    switch (slot.type)
+    {
+    case KvpValue::Type::FRAME:
+    {
+        auto frame = new KvpFrame;
+        auto rows = take_slot_rows (nested, slot.child);
+        build_slot_frame (frame, slot.name + "/", rows, nested);
+        return new KvpValue {frame};
+    }
+    case KvpValue::Type::GLIST:
+    {
+        GList* list = NULL;
+        auto rows = take_slot_rows (nested, slot.child);
+        for (auto& item : rows)
+        {
+            auto value = build_slot_value (item, nested);
+            if (value != nullptr)
+                list = g_list_prepend (list, value);
+        }
+        return new KvpValue {g_list_reverse (list)};
+    }
+    default:
+        return slot.value.release();
+    }
 }
 
+/* Slot names are the full path from the object's frame; the key in a nested
+ * frame is what follows the path of the frame's own slot.
+ */
 static void
-load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
-                           BookLookupFn lookup_fn)
+build_slot_frame (KvpFrame* frame, const std::string& parent_path,
+                  SlotRowVec& rows, SlotRowMap& nested)
 {
-    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
-                              NULL, FRAME, NULL, "" };
-    const GncGUID* guid;
-    QofInstance* inst;
+    for (auto& slot : rows)
+    {
+        auto value = build_slot_value (slot, nested);
+        if (value == nullptr)
+            continue;
+        auto key = slot.name;
+        if (key.compare (0, parent_path.size(), parent_path) == 0)
+            key.erase (0, parent_path.size());
+        delete frame->set ({key}, value);
+    }
+}
 
+void
+gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst)
+{
     g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (lookup_fn != NULL);
-
-    guid = load_obj_guid (sql_be, row);
-    g_return_if_fail (guid != NULL);
-    inst = lookup_fn (guid, sql_be->book());
-    if (inst == NULL) return; /* Silently bail if the guid isn't loaded yet. */
+    g_return_if_fail (inst != NULL);
 
-    slot_info.be = sql_be;
-    slot_info.pKvpFrame = qof_instance_get_slots (inst);
-    slot_info.path.clear();
+    auto guid = qof_instance_get_guid (inst);
+    SlotRowMap rows, nested;
+    std::string where(obj_guid_col_table[0]->name());
+    where += "='" + gnc::GUID(*guid).to_string() + "'";
 
-    gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
+    load_slot_rows (sql_be, where, rows);
+    load_nested_slot_rows (sql_be, rows, nested);
+    auto iter = rows.find (*guid);
+    if (iter != rows.end())
+        build_slot_frame (qof_instance_get_slots (inst), "", iter->second,
+                          nested);
 }
 
 /**
@@ -858,25 +896,24 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
                                           BookLookupFn lookup_fn)
 {
     g_return_if_fail (sql_be != NULL);
+    g_return_if_fail (lookup_fn != NULL);
 
     // Ignore empty subquery
     if (subquery.empty()) return;
 
-    std::string pkey(obj_guid_col_table[0]->name());
-    std::string sql("SELECT * FROM " TABLE_NAME " WHERE ");
-    sql += pkey + " IN (" + subquery + ")";
+    SlotRowMap rows, nested;
+    std::string where(obj_guid_col_table[0]->name());
+    where += " IN (" + subquery + ")";
 
-    // Execute the query and load the slots
-    auto stmt = sql_be->create_statement_from_sql(sql);
-    if (stmt == nullptr)
+    load_slot_rows (sql_be, where, rows);
+    load_nested_slot_rows (sql_be, rows, nested);
+    for (auto& obj : rows)
     {
-        PERR ("stmt == NULL, SQL = '%s'\n", sql.c_str());
-        return;
+        auto inst = lookup_fn (&obj.first, sql_be->book());
+        if (inst == NULL) continue; /* Silently bail if the guid isn't loaded yet. */
+        build_slot_frame (qof_instance_get_slots (inst), "", obj.second,
+                          nested);
     }
-    auto result = sql_be->execute_select_statement(stmt);
-    for (auto row : *result)
-        load_slot_for_book_object (sql_be, row, lookup_fn);
-    delete result;
 }
 
 /* ================================================================= */
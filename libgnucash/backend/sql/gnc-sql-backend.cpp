@@ -95,6 +95,7 @@ GncSqlBackend::connect(GncSqlConnection *conn) noexcept
         delete m_conn;
     finalize_version_info();
     m_conn = conn;
+    m_tx_load_table_in_use = false;
 }
 
 GncSqlStatementPtr
@@ -237,6 +237,11 @@ public:
     QofBook* book() const noexcept { return m_book; }
     void set_loading(bool loading) noexcept { m_loading = loading; }
     bool pristine() const noexcept { return m_is_pristine_db; }
+    bool tx_load_table_in_use() const noexcept { return m_tx_load_table_in_use; }
+    void set_tx_load_table_in_use(bool in_use) noexcept
+    {
+        m_tx_load_table_in_use = in_use;
+    }
     void update_progress(double pct) const noexcept;
     void finish_progress() const noexcept;
 
@@ -246,6 +251,8 @@ protected:
     bool m_loading;        /**< We are performing an initial load */
     bool m_in_query;       /**< We are processing a query */
     bool m_is_pristine_db; /**< Are we saving to a new pristine db? */
+    bool m_tx_load_table_in_use = false; /**< The connection's transaction
+                                          * load table holds a load's guids */
     const char* m_time_format = nullptr; /**< Server-specific date-time string format */
     VersionVec m_versions;    /**< Version number for each table */
 private:
@@ -127,8 +127,8 @@ GncSqlColumnTableEntryImpl<CT_STRING>::load (const GncSqlBackend* sql_be,
 
     try
     {
-        auto s = row.get_string_at_col (m_col_name);
-        set_parameter(pObject, s.c_str(), get_setter(obj_name), m_gobj_param_name);
+        auto s = row.get_cstring_at_col (m_col_name);
+        set_parameter(pObject, s, get_setter(obj_name), m_gobj_param_name);
     }
     catch (std::invalid_argument&) {}
 }
@@ -331,16 +331,16 @@ GncSqlColumnTableEntryImpl<CT_GUID>::load (const GncSqlBackend* sql_be,
     g_return_if_fail (pObject != NULL);
     g_return_if_fail (m_gobj_param_name != nullptr || get_setter(obj_name) != nullptr);
 
-    std::string str;
+    const char* str;
     try
     {
-        str = row.get_string_at_col(m_col_name);
+        str = row.get_cstring_at_col(m_col_name);
     }
     catch (std::invalid_argument&)
     {
         return;
     }
-    if (string_to_guid (str.c_str(), &guid))
+    if (string_to_guid (str, &guid))
         set_parameter(pObject, &guid, get_setter(obj_name), m_gobj_param_name);
 }
 
@@ -567,13 +567,13 @@ GncSqlColumnTableEntryImpl<CT_NUMERIC>::load (const GncSqlBackend* sql_be,
     gnc_numeric n;
     try
     {
-        auto buf = g_strdup_printf ("%s_num", m_col_name);
-        auto num = row.get_int_at_col (buf);
-        g_free (buf);
-        buf = g_strdup_printf ("%s_denom", m_col_name);
-        auto denom = row.get_int_at_col (buf);
+        std::string buf{m_col_name};
+        auto len = buf.size();
+        buf += "_num";
+        auto num = row.get_int_at_col (buf.c_str());
+        buf.replace (len, std::string::npos, "_denom");
+        auto denom = row.get_int_at_col (buf.c_str());
         n = gnc_numeric_create (num, denom);
-        g_free (buf);
     }
     catch (std::invalid_argument&)
     {
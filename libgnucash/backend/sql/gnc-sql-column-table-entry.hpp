@@ -192,8 +192,8 @@ public:
             try
             {
                 GncGUID guid;
-                auto val = row.get_string_at_col (m_col_name);
-                if (string_to_guid (val.c_str(), &guid))
+                auto val = row.get_cstring_at_col (m_col_name);
+                if (string_to_guid (val, &guid))
                 {
                     auto target = get_ref(&guid);
                     if (target != nullptr)
@@ -55,6 +55,7 @@ protected:
         virtual double get_float_at_col (const char* col) const = 0;
         virtual double get_double_at_col (const char* col) const = 0;
         virtual std::string get_string_at_col (const char* col) const = 0;
+        virtual const char* get_cstring_at_col (const char* col) const = 0;
         virtual time64 get_time64_at_col (const char* col) const = 0;
         virtual bool is_col_null (const char* col) const noexcept = 0;
     };
@@ -94,6 +95,12 @@ public:
         return m_iter->get_double_at_col (col); }
     std::string get_string_at_col (const char* col) const {
         return m_iter->get_string_at_col (col); }
+    /**
+     * Like get_string_at_col but without copying the string. It is owned by
+     * the result set and must not be used after the result is freed.
+     */
+    const char* get_cstring_at_col (const char* col) const {
+        return m_iter->get_cstring_at_col (col); }
     time64 get_time64_at_col (const char* col) const {
         return m_iter->get_time64_at_col (col); }
     bool is_col_null (const char* col) const noexcept {
@@ -49,6 +49,7 @@ extern "C"
 #endif
 }
 
+#include <algorithm>
 #include <string>
 #include <sstream>
 
@@ -71,6 +72,9 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define TX_TABLE_VERSION 4
 #define SPLIT_TABLE "splits"
 #define SPLIT_TABLE_VERSION 5
+/* Temporary table holding the guids of the transactions being loaded. */
+#define TX_LOAD_TABLE "gnc_tx_load"
+#define TX_LOAD_BATCH_SIZE 500
 
 struct split_info_t : public write_objects_t
 {
@@ -248,18 +252,9 @@ load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
 
     const std::string spkey(split_col_table[0]->name());
     const std::string sskey(tx_guid_col_table[0]->name());
-    const std::string tpkey(tx_col_table[0]->name());
 
-    std::string sql("SELECT ");
-    if (selector.empty())
-    {
-        sql += SPLIT_TABLE ".* FROM " SPLIT_TABLE " INNER JOIN "
-            TRANSACTION_TABLE " ON " SPLIT_TABLE "." + sskey + " = "
-            TRANSACTION_TABLE "." + tpkey;
-        selector = "(SELECT DISTINCT " + tpkey + " FROM " TRANSACTION_TABLE ")";
-    }
-    else
-        sql += " * FROM " SPLIT_TABLE " WHERE " + sskey + " IN " + selector;
+    std::string sql("SELECT * FROM " SPLIT_TABLE " WHERE ");
+    sql += sskey + " IN " + selector;
 
     // Execute the query and load the splits
     auto stmt = sql_be->create_statement_from_sql(sql);
@@ -267,12 +262,111 @@ load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
 
     for (auto row : *result)
         load_single_split (sql_be, row);
+    delete result;
     sql = "SELECT DISTINCT ";
     sql += spkey + " FROM " SPLIT_TABLE " WHERE " + sskey + " IN " + selector;
     gnc_sql_slots_load_for_sql_subquery(sql_be, sql,
                                         (BookLookupFn)xaccSplitLookup);
 }
 
+/**
+ * Loads the splits of the transactions whose guids are in tx_table, which
+ * is either the transactions table or TX_LOAD_TABLE, and the slots of the
+ * transactions and splits. The splits are selected by joining on tx_table
+ * so the database can use the index on splits.tx_guid.
+ */
+static void
+load_splits_for_tx_table (GncSqlBackend* sql_be, const std::string& tx_table)
+{
+    const std::string spkey(split_col_table[0]->name());
+    const std::string sskey(tx_guid_col_table[0]->name());
+    const std::string tpkey(tx_col_table[0]->name());
+
+    std::string join(" FROM " SPLIT_TABLE " INNER JOIN ");
+    join += tx_table + " ON " SPLIT_TABLE "." + sskey + " = " + tx_table +
+        "." + tpkey;
+
+    auto stmt = sql_be->create_statement_from_sql("SELECT " SPLIT_TABLE ".*" +
+                                                  join);
+    auto result = sql_be->execute_select_statement (stmt);
+    for (auto row : *result)
+        load_single_split (sql_be, row);
+    delete result;
+
+    gnc_sql_slots_load_for_sql_subquery (sql_be,
+                                         "SELECT " SPLIT_TABLE "." + spkey + join,
+                                         (BookLookupFn)xaccSplitLookup);
+    gnc_sql_slots_load_for_sql_subquery (sql_be,
+                                         "SELECT " + tpkey + " FROM " + tx_table,
+                                         (BookLookupFn)xaccTransLookup);
+}
+
+/* A failure to drop the table must not fail the load it was used for; a
+ * later load will find the table still there and not use it. */
+static void
+drop_tx_load_table (GncSqlBackend* sql_be)
+{
+    auto stmt = sql_be->create_statement_from_sql("DROP TABLE " TX_LOAD_TABLE);
+    if (sql_be->execute_nonselect_statement (stmt) < 0)
+    {
+        PWARN ("Failed to drop " TX_LOAD_TABLE);
+        (void)sql_be->get_error();
+    }
+    sql_be->set_tx_load_table_in_use (false);
+}
+
+/**
+ * Copies the guids of the transactions into TX_LOAD_TABLE. The table is
+ * created from the transactions table so that its guid column has the same
+ * type and collation.
+ *
+ * @return false if the table is already in use by an outer load or couldn't
+ * be filled; the caller must then use the transaction selector instead.
+ * Errors from failed attempts are cleared so that they don't fail the load.
+ */
+static bool
+create_tx_load_table (GncSqlBackend* sql_be, const InstanceVec& instances)
+{
+    if (sql_be->tx_load_table_in_use() || sql_be->check_error())
+        return false;
+
+    const std::string tpkey(tx_col_table[0]->name());
+    std::string sql("CREATE TEMPORARY TABLE " TX_LOAD_TABLE " AS SELECT ");
+    sql += tpkey + " FROM " TRANSACTION_TABLE " WHERE 1=0";
+    auto stmt = sql_be->create_statement_from_sql(sql);
+    if (sql_be->execute_nonselect_statement (stmt) < 0)
+    {
+        (void)sql_be->get_error();
+        return false;
+    }
+    sql_be->set_tx_load_table_in_use (true);
+
+    char guid_buf[GUID_ENCODING_LENGTH + 1];
+    for (size_t start = 0; start < instances.size();
+         start += TX_LOAD_BATCH_SIZE)
+    {
+        std::stringstream insert;
+        insert << "INSERT INTO " TX_LOAD_TABLE " (" << tpkey << ") VALUES ";
+        auto end = std::min (instances.size(), start + TX_LOAD_BATCH_SIZE);
+        for (auto idx = start; idx < end; ++idx)
+        {
+            (void)guid_to_string_buff (qof_instance_get_guid (instances[idx]),
+                                       guid_buf);
+            if (idx != start)
+                insert << ",";
+            insert << "('" << guid_buf << "')";
+        }
+        stmt = sql_be->create_statement_from_sql(insert.str());
+        if (sql_be->execute_nonselect_statement (stmt) < 0)
+        {
+            drop_tx_load_table (sql_be);
+            (void)sql_be->get_error();
+            return false;
+        }
+    }
+    return true;
+}
+
 static  Transaction*
 load_single_tx (GncSqlBackend* sql_be, GncSqlRow& row)
 {
@@ -366,9 +460,18 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     }
 
     // Load all splits and slots for the transactions
-    if (!instances.empty())
+    if (!instances.empty() && selector.empty())
+    {
+        load_splits_for_tx_table (sql_be, TRANSACTION_TABLE);
+    }
+    else if (!instances.empty() &&
+             create_tx_load_table (sql_be, instances))
+    {
+        load_splits_for_tx_table (sql_be, TX_LOAD_TABLE);
+        drop_tx_load_table (sql_be);
+    }
+    else if (!instances.empty())
     {
-        const std::string tpkey(tx_col_table[0]->name());
         if (!selector.empty() && (selector[0] != '('))
         {
             auto tselector = std::string ("(SELECT DISTINCT ");
@@ -377,12 +480,6 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
         }
 
         load_splits_for_transactions (sql_be, selector);
-
-        if (selector.empty())
-        {
-            selector = "SELECT DISTINCT ";
-            selector += tpkey + " FROM " TRANSACTION_TABLE;
-        }
         gnc_sql_slots_load_for_sql_subquery (sql_be, selector,
 					     (BookLookupFn)xaccTransLookup);
     }
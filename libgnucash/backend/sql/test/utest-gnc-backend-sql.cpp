@@ -72,6 +72,8 @@ protected:
             { return 1.0; }
             virtual std::string get_string_at_col (const char* col)const
             { return std::string{"foo"}; }
+            virtual const char* get_cstring_at_col (const char* col) const
+            { return "foo"; }
             virtual time64 get_time64_at_col (const char* col) const
             { return 1466270857LL; }
             virtual bool is_col_null(const char* col) const noexcept
@@ -43,13 +43,23 @@
 #include "gnc-features.h"
 #include "guid.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <map>
 #include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
 
 /* The Canonical Account Separator.  Pre-Initialized. */
 static gchar account_separator[8] = ".";
 static gunichar account_uc_separator = ':';
+/* Bumped when the separator changes, which alters the full name of
+ * every account.  Renames and tree changes update the cached names and
+ * indexes of the accounts they move instead. */
+static guint account_separator_generation = 1;
 /* Predefined KVP paths */
 static const std::string KEY_ASSOC_INCOME_ACCOUNT("ofx/associated-income-account");
 static const std::string KEY_RECONCILE_INFO("reconcile-info");
@@ -63,7 +73,25 @@ static const std::string AB_ACCOUNT_UID("account-uid");
 static const std::string AB_BANK_CODE("bank-code");
 static const std::string AB_TRANS_RETRIEVAL("trans-retrieval");
 
+/* The full names of all the descendants of a root account, built on the
+ * first lookup and then kept up to date by renames and tree changes.
+ * Several accounts may share a full name; the lookup returns the first
+ * of them in tree traversal order, which is the one the recursive search
+ * finds. */
+struct FullNameIndex
+{
+    guint generation;
+    std::unordered_map<std::string, std::vector<Account*>> accounts;
+};
+
 static gnc_numeric GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing);
+static void account_free_open_lots (AccountPrivate *priv);
+static void account_free_full_names (AccountPrivate *priv);
+static FullNameIndex *account_get_full_name_index (const Account *account);
+static void account_index_full_names (FullNameIndex *index, Account *account);
+static void account_unindex_full_names (FullNameIndex *index, Account *account);
+static void account_forget_full_names (Account *account);
+static gboolean account_name_indexable (const Account *account);
 
 using FinalProbabilityVec=std::vector<std::pair<std::string, int32_t>>;
 using ProbabilityVec=std::vector<std::pair<std::string, struct AccountProbability>>;
@@ -162,6 +190,7 @@ gnc_set_account_separator (const gchar *separator)
     gunichar uc;
     gint count;
 
+    account_separator_generation++;
     uc = g_utf8_get_char_validated(separator, -1);
     if ((uc == (gunichar) - 2) || (uc == (gunichar) - 1) || g_unichar_isalnum(uc))
     {
@@ -266,6 +295,11 @@ gnc_account_init(Account* acc)
     priv = GET_PRIVATE(acc);
     priv->parent   = NULL;
     priv->children = NULL;
+    priv->children_array = NULL;
+    priv->child_index = 0;
+    priv->full_name = NULL;
+    priv->full_name_generation = 0;
+    priv->full_name_index = nullptr;
 
     priv->accountName = static_cast<char*>(qof_string_cache_insert(""));
     priv->accountCode = static_cast<char*>(qof_string_cache_insert(""));
@@ -277,6 +311,7 @@ gnc_account_init(Account* acc)
 
     priv->policy = xaccGetFIFOPolicy();
     priv->lots = NULL;
+    priv->open_lots = nullptr;
 
     priv->commodity = NULL;
     priv->commodity_scu = 0;
@@ -1216,6 +1251,17 @@ xaccFreeOneChildAccount (Account *acc, gpointer dummy)
     xaccAccountDestroy(acc);
 }
 
+/* Drop the indexed copy of the children, it has to be rebuilt
+ * after the children list was modified. */
+static void
+account_children_changed (AccountPrivate *priv)
+{
+    if (!priv->children_array)
+        return;
+    g_ptr_array_free (priv->children_array, TRUE);
+    priv->children_array = NULL;
+}
+
 static void
 xaccFreeAccountChildren (Account *acc)
 {
@@ -1232,6 +1278,7 @@ xaccFreeAccountChildren (Account *acc)
     if (priv->children)
         g_list_free(priv->children);
     priv->children = NULL;
+    account_children_changed (priv);
 }
 
 /* The xaccFreeAccount() routine releases memory associated with the
@@ -1272,6 +1319,7 @@ xaccFreeAccount (Account *acc)
         g_list_free (priv->lots);
         priv->lots = NULL;
     }
+    account_free_open_lots (priv);
 
     /* Next, clean up the splits */
     /* NB there shouldn't be any splits by now ... they should
@@ -1302,12 +1350,14 @@ xaccFreeAccount (Account *acc)
     qof_string_cache_remove(priv->accountCode);
     qof_string_cache_remove(priv->description);
     priv->accountName = priv->accountCode = priv->description = nullptr;
+    account_free_full_names (priv);
 
     /* zero out values, just in case stray
      * pointers are pointing here. */
 
     priv->parent = nullptr;
     priv->children = nullptr;
+    account_children_changed (priv);
 
     priv->balance  = gnc_numeric_zero();
     priv->noclosing_balance = gnc_numeric_zero();
@@ -1437,6 +1487,7 @@ xaccAccountCommitEdit (Account *acc)
         }
         g_list_free(priv->lots);
         priv->lots = NULL;
+        account_free_open_lots (priv);
 
         qof_instance_set_dirty(&acc->inst);
         qof_instance_decrease_editlevel(acc);
@@ -1979,6 +2030,161 @@ gnc_account_set_policy (Account *acc, GNCPolicy *policy)
     priv->policy = policy ? policy : xaccGetFIFOPolicy();
 }
 
+/********************************************************************\
+ * Open lot index                                                   *
+ *                                                                  *
+ * Finding the lot a split should go in used to test every lot in   *
+ * the account, which becomes quadratic when assigning all splits   *
+ * of an account with many lots. Instead keep the open lots sorted  *
+ * by the posted date of their opening split, separately for lots   *
+ * opened by a positive and by a negative split. Lots that changed  *
+ * since they were indexed are only re-indexed when the index is    *
+ * used next.                                                       *
+ *                                                                  *
+ * Lots opened on the same date are ordered by their position in    *
+ * the account's lot list, so that both the earliest and the latest *
+ * lookups pick the first of them in list order like the old linear *
+ * search did.                                                      *
+\********************************************************************/
+
+struct OpenLotIndex
+{
+    /* (posted date, rank in priv->lots) */
+    using LotsByDate = std::map<std::pair<time64, int64_t>, GNCLot*>;
+    struct Entry
+    {
+        bool positive;
+        LotsByDate::iterator pos;
+    };
+
+    LotsByDate lots[2];     /* [0]: negative openings, [1]: positive ones */
+    std::unordered_map<GNCLot*, Entry> entries;
+    std::unordered_set<GNCLot*> stale;
+    /* Lots are only ever prepended to priv->lots, so a lot's rank never
+     * changes while it stays in the account; new lots get the next lower
+     * rank. */
+    std::unordered_map<GNCLot*, int64_t> ranks;
+    int64_t front_rank = 0;
+};
+
+static void
+open_lots_remove (OpenLotIndex *index, GNCLot *lot)
+{
+    auto entry = index->entries.find (lot);
+    if (entry == index->entries.end())
+        return;
+    index->lots[entry->second.positive].erase (entry->second.pos);
+    index->entries.erase (entry);
+}
+
+static void
+open_lots_insert (OpenLotIndex *index, GNCLot *lot)
+{
+    if (gnc_lot_is_closed (lot))
+        return;
+
+    auto split = gnc_lot_get_earliest_split (lot);
+    if (!split || gnc_numeric_zero_p (xaccSplitGetAmount (split)))
+        return;
+
+    auto rank = index->ranks.find (lot);
+    if (rank == index->ranks.end())
+        rank = index->ranks.emplace (lot, --index->front_rank).first;
+
+    bool positive = gnc_numeric_positive_p (xaccSplitGetAmount (split));
+    auto posted = xaccTransGetDate (xaccSplitGetParent (split));
+    auto pos = index->lots[positive].emplace (std::make_pair (posted, rank->second),
+                                              lot).first;
+    index->entries.emplace (lot, OpenLotIndex::Entry{positive, pos});
+}
+
+static void
+account_free_open_lots (AccountPrivate *priv)
+{
+    delete priv->open_lots;
+    priv->open_lots = nullptr;
+}
+
+/* Drop a lot that no longer belongs to the account from its index. */
+static void
+account_open_lots_forget (AccountPrivate *priv, GNCLot *lot)
+{
+    if (!priv->open_lots)
+        return;
+    open_lots_remove (priv->open_lots, lot);
+    priv->open_lots->stale.erase (lot);
+    priv->open_lots->ranks.erase (lot);
+}
+
+static OpenLotIndex *
+account_get_open_lots (Account *acc)
+{
+    auto priv = GET_PRIVATE(acc);
+
+    if (!priv->open_lots)
+    {
+        priv->open_lots = new OpenLotIndex;
+        int64_t rank = 0;
+        for (auto node = priv->lots; node; node = g_list_next (node))
+            priv->open_lots->ranks.emplace (GNC_LOT(node->data), rank++);
+        for (auto node = priv->lots; node; node = g_list_next (node))
+            open_lots_insert (priv->open_lots, GNC_LOT(node->data));
+        return priv->open_lots;
+    }
+
+    for (auto lot : priv->open_lots->stale)
+    {
+        open_lots_remove (priv->open_lots, lot);
+        if (gnc_lot_get_account (lot) == acc)
+            open_lots_insert (priv->open_lots, lot);
+    }
+    priv->open_lots->stale.clear();
+    return priv->open_lots;
+}
+
+void
+xaccAccountLotChanged (Account *acc, GNCLot *lot)
+{
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    auto priv = GET_PRIVATE(acc);
+    if (priv->open_lots)
+        priv->open_lots->stale.insert (lot);
+}
+
+GNCLot *
+xaccAccountFindOpenLotByDate (Account *acc, gboolean positive_opening,
+                              gboolean latest,
+                              gboolean (*match_func)(GNCLot *lot,
+                                                     gpointer user_data),
+                              gpointer user_data)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+
+    auto& lots = account_get_open_lots (acc)->lots[positive_opening ? 1 : 0];
+    if (latest)
+    {
+        /* Walk the dates backwards, but the lots of one date forwards. */
+        auto end = lots.end();
+        while (end != lots.begin())
+        {
+            auto posted = std::prev (end)->first.first;
+            auto first = lots.lower_bound (std::make_pair (posted, INT64_MIN));
+            for (auto lot = first; lot != end; ++lot)
+                if (match_func (lot->second, user_data))
+                    return lot->second;
+            end = first;
+        }
+    }
+    else
+    {
+        for (auto lot = lots.begin(); lot != lots.end(); ++lot)
+            if (match_func (lot->second, user_data))
+                return lot->second;
+    }
+    return NULL;
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -1995,6 +2201,7 @@ xaccAccountRemoveLot (Account *acc, GNCLot *lot)
 
     ENTER ("(acc=%p, lot=%p)", acc, lot);
     priv->lots = g_list_remove(priv->lots, lot);
+    account_open_lots_forget (priv, lot);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_REMOVE, NULL);
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     LEAVE ("(acc=%p, lot=%p)", acc, lot);
@@ -2024,11 +2231,13 @@ xaccAccountInsertLot (Account *acc, GNCLot *lot)
         old_acc = lot_account;
         opriv = GET_PRIVATE(old_acc);
         opriv->lots = g_list_remove(opriv->lots, lot);
+        account_open_lots_forget (opriv, lot);
     }
 
     priv = GET_PRIVATE(acc);
     priv->lots = g_list_prepend(priv->lots, lot);
     gnc_lot_set_account(lot, acc);
+    xaccAccountLotChanged (acc, lot);
 
     /* Don't move the splits to the new account.  The caller will do this
      * if appropriate, and doing it here will not work if we are being
@@ -2319,7 +2528,19 @@ xaccAccountSetName (Account *acc, const char *str)
         return;
 
     xaccAccountBeginEdit(acc);
-    priv->accountName = qof_string_cache_replace(priv->accountName, str);
+    /* The name of a root account isn't part of any full name. */
+    if (priv->parent)
+    {
+        auto index = account_get_full_name_index (acc);
+        if (index)
+            account_unindex_full_names (index, acc);
+        priv->accountName = qof_string_cache_replace(priv->accountName, str);
+        account_forget_full_names (acc);
+        if (index && account_name_indexable (priv->parent))
+            account_index_full_names (index, acc);
+    }
+    else
+        priv->accountName = qof_string_cache_replace(priv->accountName, str);
     mark_account (acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2634,6 +2855,17 @@ gnc_account_append_child (Account *new_parent, Account *child)
     }
     cpriv->parent = new_parent;
     ppriv->children = g_list_append(ppriv->children, child);
+    account_children_changed (ppriv);
+
+    /* The child's names were relative to itself or its old parent, and
+     * it no longer is a root with an index of its own. */
+    account_forget_full_names (child);
+    delete cpriv->full_name_index;
+    cpriv->full_name_index = nullptr;
+    auto index = account_get_full_name_index (new_parent);
+    if (index && account_name_indexable (new_parent))
+        account_index_full_names (index, child);
+
     qof_instance_set_dirty(&new_parent->inst);
     qof_instance_set_dirty(&child->inst);
 
@@ -2671,15 +2903,20 @@ gnc_account_remove_child (Account *parent, Account *child)
 
     /* Gather event data */
     ed.node = parent;
-    ed.idx = g_list_index(ppriv->children, child);
+    ed.idx = gnc_account_child_index (parent, child);
 
+    auto index = account_get_full_name_index (parent);
+    if (index)
+        account_unindex_full_names (index, child);
     ppriv->children = g_list_remove(ppriv->children, child);
+    account_children_changed (ppriv);
 
     /* Now send the event. */
     qof_event_gen(&child->inst, QOF_EVENT_REMOVE, &ed);
 
     /* clear the account's parent pointer after REMOVE event generation. */
     cpriv->parent = NULL;
+    account_forget_full_names (child);
 
     qof_event_gen (&parent->inst, QOF_EVENT_MODIFY, NULL);
 }
@@ -2737,11 +2974,33 @@ gnc_account_get_children_sorted (const Account *account)
     return g_list_sort(g_list_copy(priv->children), (GCompareFunc)xaccAccountOrder);
 }
 
+/* Returns the indexed copy of the account's children, (re)building it
+ * if the children list changed since it was last used. This also
+ * refreshes the cached position of each child. */
+static GPtrArray *
+account_get_children_array (const Account *account)
+{
+    AccountPrivate *priv = GET_PRIVATE(account);
+    GList *node;
+    gint i = 0;
+
+    if (priv->children_array)
+        return priv->children_array;
+
+    priv->children_array = g_ptr_array_sized_new (g_list_length (priv->children));
+    for (node = priv->children; node; node = g_list_next(node), i++)
+    {
+        g_ptr_array_add (priv->children_array, node->data);
+        GET_PRIVATE(node->data)->child_index = i;
+    }
+    return priv->children_array;
+}
+
 gint
 gnc_account_n_children (const Account *account)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(account), 0);
-    return g_list_length(GET_PRIVATE(account)->children);
+    return account_get_children_array (account)->len;
 }
 
 gint
@@ -2749,14 +3008,22 @@ gnc_account_child_index (const Account *parent, const Account *child)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(parent), -1);
     g_return_val_if_fail(GNC_IS_ACCOUNT(child), -1);
-    return g_list_index(GET_PRIVATE(parent)->children, child);
+    if (GET_PRIVATE(child)->parent != parent)
+        return -1;
+    account_get_children_array (parent);
+    return GET_PRIVATE(child)->child_index;
 }
 
 Account *
 gnc_account_nth_child (const Account *parent, gint num)
 {
+    GPtrArray *children;
+
     g_return_val_if_fail(GNC_IS_ACCOUNT(parent), NULL);
-    return static_cast<Account*>(g_list_nth_data(GET_PRIVATE(parent)->children, num));
+    children = account_get_children_array (parent);
+    if (num < 0 || (guint)num >= children->len)
+        return NULL;
+    return static_cast<Account*>(g_ptr_array_index (children, num));
 }
 
 gint
@@ -2934,6 +3201,43 @@ gnc_account_lookup_by_code (const Account *parent, const char * code)
  * Fetch an account, given its full name                            *
 \********************************************************************/
 
+/* The full name of account, built from its parent's.  Renaming or
+ * moving an account forgets the names of its subtree; changing the
+ * separator makes all of them stale.  The root account itself isn't
+ * part of the name. */
+static const char *
+account_get_cached_full_name (const Account *account)
+{
+    AccountPrivate *priv = GET_PRIVATE(account);
+
+    if (priv->full_name &&
+        priv->full_name_generation == account_separator_generation)
+        return priv->full_name;
+
+    g_free (priv->full_name);
+    if (!priv->parent)
+        priv->full_name = g_strdup ("");
+    else if (!GET_PRIVATE(priv->parent)->parent)
+        priv->full_name = g_strdup (priv->accountName);
+    else
+        priv->full_name = g_strconcat (account_get_cached_full_name (priv->parent),
+                                       account_separator, priv->accountName,
+                                       NULL);
+    priv->full_name_generation = account_separator_generation;
+    return priv->full_name;
+}
+
+static void
+account_forget_full_names (Account *account)
+{
+    AccountPrivate *priv = GET_PRIVATE(account);
+
+    g_free (priv->full_name);
+    priv->full_name = NULL;
+    for (auto node = priv->children; node; node = node->next)
+        account_forget_full_names (static_cast<Account*>(node->data));
+}
+
 static Account *
 gnc_account_lookup_by_full_name_helper (const Account *parent,
                                         gchar **names)
@@ -2976,11 +3280,109 @@ gnc_account_lookup_by_full_name_helper (const Account *parent,
 }
 
 
+/* The index of the root of account's tree, if it has a current one. */
+static FullNameIndex *
+account_get_full_name_index (const Account *account)
+{
+    while (GET_PRIVATE(account)->parent)
+        account = GET_PRIVATE(account)->parent;
+    auto index = GET_PRIVATE(account)->full_name_index;
+    if (!index || index->generation != account_separator_generation)
+        return nullptr;
+    return index;
+}
+
+/* Names containing the separator can't be found by splitting a full
+ * name, and neither can their descendants. */
+static gboolean
+account_name_indexable (const Account *account)
+{
+    for (; GET_PRIVATE(account)->parent; account = GET_PRIVATE(account)->parent)
+        if (strstr (GET_PRIVATE(account)->accountName, account_separator))
+            return FALSE;
+    return TRUE;
+}
+
+/* Adds account and its descendants; the caller checks its ancestors. */
+static void
+account_index_full_names (FullNameIndex *index, Account *account)
+{
+    AccountPrivate *priv = GET_PRIVATE(account);
+
+    if (strstr (priv->accountName, account_separator))
+        return;
+    index->accounts[account_get_cached_full_name (account)].push_back (account);
+    for (auto node = priv->children; node; node = node->next)
+        account_index_full_names (index, static_cast<Account*>(node->data));
+}
+
+static void
+account_unindex_full_names (FullNameIndex *index, Account *account)
+{
+    AccountPrivate *priv = GET_PRIVATE(account);
+
+    if (strstr (priv->accountName, account_separator))
+        return;
+    auto entry = index->accounts.find (account_get_cached_full_name (account));
+    if (entry != index->accounts.end())
+    {
+        auto& accounts = entry->second;
+        accounts.erase (std::remove (accounts.begin(), accounts.end(), account),
+                        accounts.end());
+        if (accounts.empty())
+            index->accounts.erase (entry);
+    }
+    for (auto node = priv->children; node; node = node->next)
+        account_unindex_full_names (index, static_cast<Account*>(node->data));
+}
+
+/* Whether a comes before b in a depth-first traversal of their tree. */
+static bool
+account_precedes (const Account *a, const Account *b)
+{
+    std::vector<const Account*> path_a, path_b;
+
+    for (; a; a = GET_PRIVATE(a)->parent)
+        path_a.push_back (a);
+    for (; b; b = GET_PRIVATE(b)->parent)
+        path_b.push_back (b);
+
+    auto iter_a = path_a.rbegin(), iter_b = path_b.rbegin();
+    while (iter_a != path_a.rend() && iter_b != path_b.rend() &&
+           *iter_a == *iter_b)
+    {
+        ++iter_a;
+        ++iter_b;
+    }
+    if (iter_a == path_a.rend() || iter_b == path_b.rend())
+        return iter_a == path_a.rend() && iter_b != path_b.rend();
+
+    /* Siblings under the last common ancestor. */
+    auto parent = GET_PRIVATE(*iter_a)->parent;
+    for (auto node = GET_PRIVATE(parent)->children; node; node = node->next)
+    {
+        if (node->data == *iter_a)
+            return true;
+        if (node->data == *iter_b)
+            return false;
+    }
+    return false;
+}
+
+static void
+account_free_full_names (AccountPrivate *priv)
+{
+    g_free (priv->full_name);
+    priv->full_name = NULL;
+    delete priv->full_name_index;
+    priv->full_name_index = nullptr;
+}
+
 Account *
 gnc_account_lookup_by_full_name (const Account *any_acc,
                                  const gchar *name)
 {
-    const AccountPrivate *rpriv;
+    AccountPrivate *rpriv;
     const Account *root;
     Account *found;
     gchar **names;
@@ -2995,6 +3397,27 @@ gnc_account_lookup_by_full_name (const Account *any_acc,
         root = rpriv->parent;
         rpriv = GET_PRIVATE(root);
     }
+
+    if (*name)
+    {
+        auto index = rpriv->full_name_index;
+        if (!index)
+            index = rpriv->full_name_index = new FullNameIndex{0, {}};
+        if (index->generation != account_separator_generation)
+        {
+            index->accounts.clear();
+            for (auto node = rpriv->children; node; node = node->next)
+                account_index_full_names (index,
+                                          static_cast<Account*>(node->data));
+            index->generation = account_separator_generation;
+        }
+        auto entry = index->accounts.find (name);
+        if (entry == index->accounts.end())
+            return NULL;
+        return *std::min_element (entry->second.begin(), entry->second.end(),
+                                  account_precedes);
+    }
+
     names = g_strsplit(name, gnc_get_account_separator_string(), -1);
     found = gnc_account_lookup_by_full_name_helper(root, names);
     g_strfreev(names);
@@ -3102,12 +3525,6 @@ xaccAccountGetName (const Account *acc)
 gchar *
 gnc_account_get_full_name(const Account *account)
 {
-    AccountPrivate *priv;
-    const Account *a;
-    char *fullname;
-    gchar **names;
-    int level;
-
     /* So much for hardening the API. Too many callers to this function don't
      * bother to check if they have a non-NULL pointer before calling. */
     if (NULL == account)
@@ -3116,35 +3533,7 @@ gnc_account_get_full_name(const Account *account)
     /* errors */
     g_return_val_if_fail(GNC_IS_ACCOUNT(account), g_strdup(""));
 
-    /* optimizations */
-    priv = GET_PRIVATE(account);
-    if (!priv->parent)
-        return g_strdup("");
-
-    /* Figure out how much space is needed by counting the nodes up to
-     * the root. */
-    level = 0;
-    for (a = account; a; a = priv->parent)
-    {
-        priv = GET_PRIVATE(a);
-        level++;
-    }
-
-    /* Get all the pointers in the right order. The root node "entry"
-     * becomes the terminating NULL pointer for the array of strings. */
-    names = (gchar **)g_malloc(level * sizeof(gchar *));
-    names[--level] = NULL;
-    for (a = account; level > 0; a = priv->parent)
-    {
-        priv = GET_PRIVATE(a);
-        names[--level] = priv->accountName;
-    }
-
-    /* Build the full name */
-    fullname =  g_strjoinv(account_separator, names);
-    g_free(names);
-
-    return fullname;
+    return g_strdup(account_get_cached_full_name(account));
 }
 
 const char *
@@ -3758,6 +4147,93 @@ xaccAccountGetNoclosingBalanceChangeForPeriod (Account *acc, time64 t1,
     return gnc_numeric_sub(b2, b1, GNC_DENOM_AUTO, GNC_HOW_DENOM_FIXED);
 }
 
+static gboolean
+split_counts_for_balance (const Split *split, GNCAccountBalanceKind kind)
+{
+    switch (kind)
+    {
+    case ACCOUNT_BALANCE_NOCLOSING:
+        return !xaccTransGetIsClosingTxn (split->parent);
+    case ACCOUNT_BALANCE_CLEARED:
+        return split->reconciled != NREC;
+    case ACCOUNT_BALANCE_RECONCILED:
+        return split->reconciled == YREC || split->reconciled == FREC;
+    default:
+        return TRUE;
+    }
+}
+
+/* Fill balances[0..n_dates) with the balance of a single account at
+ * each date.  The split list is sorted by posted date, so one pass
+ * over it serves every date. */
+static void
+account_balances_at_dates (Account *acc, const time64 *dates, guint n_dates,
+                           GNCAccountBalanceKind kind, gnc_numeric *balances)
+{
+    gnc_numeric balance = gnc_numeric_zero ();
+    GList *node;
+    guint i = 0;
+
+    xaccAccountSortSplits (acc, FALSE);
+    node = GET_PRIVATE(acc)->splits;
+
+    for (; i < n_dates; i++)
+    {
+        for (; node; node = node->next)
+        {
+            Split *split = (Split *) node->data;
+
+            if (xaccTransGetDate (split->parent) > dates[i])
+                break;
+            if (split_counts_for_balance (split, kind))
+                balance = gnc_numeric_add_fixed (balance, split->amount);
+        }
+        balances[i] = balance;
+    }
+}
+
+gnc_numeric *
+xaccAccountListGetBalancesAtDates (AccountList *accounts, const time64 *dates,
+                                   guint n_dates, GNCAccountBalanceKind kind,
+                                   gnc_commodity *report_commodity)
+{
+    gnc_numeric *totals, *balances;
+    GList *node;
+    guint i;
+
+    g_return_val_if_fail (dates || n_dates == 0, NULL);
+
+    totals = g_new (gnc_numeric, n_dates);
+    balances = g_new (gnc_numeric, n_dates);
+    for (i = 0; i < n_dates; i++)
+        totals[i] = gnc_numeric_zero ();
+
+    for (node = accounts; node; node = node->next)
+    {
+        Account *acc = GNC_ACCOUNT(node->data);
+        gnc_commodity *commodity = xaccAccountGetCommodity (acc);
+
+        account_balances_at_dates (acc, dates, n_dates, kind, balances);
+
+        for (i = 0; i < n_dates; i++)
+        {
+            if (!report_commodity)
+            {
+                totals[i] = gnc_numeric_add_fixed (totals[i], balances[i]);
+                continue;
+            }
+            balances[i] = xaccAccountConvertBalanceToCurrencyAsOfDate
+                (acc, balances[i], commodity, report_commodity, dates[i]);
+            totals[i] = gnc_numeric_add (totals[i], balances[i],
+                                         gnc_commodity_get_fraction (report_commodity),
+                                         GNC_HOW_RND_ROUND_HALF_UP);
+        }
+    }
+
+    g_free (balances);
+    return totals;
+}
+
 
 /********************************************************************\
 \********************************************************************/
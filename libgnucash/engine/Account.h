@@ -614,6 +614,40 @@ gnc_numeric xaccAccountGetNoclosingBalanceChangeForPeriod (
 gnc_numeric xaccAccountGetBalanceChangeForPeriod (
     Account *acc, time64 date1, time64 date2, gboolean recurse);
 
+/** Which splits xaccAccountListGetBalancesAtDates() adds up. */
+typedef enum
+{
+    ACCOUNT_BALANCE_TOTAL,      /**< All splits */
+    ACCOUNT_BALANCE_NOCLOSING,  /**< Splits not in closing transactions */
+    ACCOUNT_BALANCE_CLEARED,    /**< Cleared and reconciled splits */
+    ACCOUNT_BALANCE_RECONCILED, /**< Reconciled and frozen splits */
+} GNCAccountBalanceKind;
+
+/** Compute the balance of a set of accounts at each of several dates,
+ *  walking each account's splits once.
+ *
+ *  @param accounts The accounts to add up. Children are not included
+ *  unless they are in the list.
+ *
+ *  @param dates The dates, in ascending order. The balance at a date
+ *  includes the splits of transactions posted on or before it.
+ *
+ *  @param n_dates The number of dates.
+ *
+ *  @param kind Which splits to count.
+ *
+ *  @param report_commodity If not NULL, each account's balance is
+ *  converted to it at the price nearest to each date. If NULL, the
+ *  amounts are added unconverted, which only makes sense if all the
+ *  accounts have the same commodity.
+ *
+ *  @return A newly allocated array of n_dates balances; free it with
+ *  g_free().
+ */
+gnc_numeric *xaccAccountListGetBalancesAtDates (
+    AccountList *accounts, const time64 *dates, guint n_dates,
+    GNCAccountBalanceKind kind, gnc_commodity *report_commodity);
+
 /** @} */
 
 /** @name Account Children and Parents.
@@ -102,6 +102,22 @@ typedef struct AccountPrivate
     Account *parent;    /* back-pointer to parent */
     GList *children;    /* list of sub-accounts */
 
+    /* Indexed copy of children, built on demand and dropped whenever the
+     * children list changes. child_index is this account's position in
+     * its parent's children; it's only valid while the parent's
+     * children_array exists. */
+    GPtrArray *children_array;
+    gint child_index;
+
+    /* Cached full name and, on an account without a parent, the index
+     * of the full names of its descendants used by
+     * gnc_account_lookup_by_full_name.  Renames and tree changes
+     * update both; each is only valid for the separator generation it
+     * was made in. */
+    char *full_name;
+    guint full_name_generation;
+    struct FullNameIndex *full_name_index;
+
     /* protected data - should only be set by backends */
     gnc_numeric starting_balance;
     gnc_numeric starting_noclosing_balance;
@@ -122,6 +138,10 @@ typedef struct AccountPrivate
     LotList   *lots;		/* list of lot pointers */
     GNCPolicy *policy;		/* Cached pointer to policy method */
 
+    /* Index of the open lots by opening date, built on first use by
+     * xaccAccountFindOpenLotByDate and kept up to date from there on. */
+    struct OpenLotIndex *open_lots;
+
     /* The "mark" flag can be used by the user to mark this account
      * in any way desired.  Handy for specialty traversals of the
      * account tree. */
@@ -141,6 +161,22 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Tell the account one of its lots changed in a way that may affect its
+ * open state or opening date: splits were added to or removed from the
+ * lot, or the amounts or dates of its splits were edited. */
+void xaccAccountLotChanged (Account *acc, GNCLot *lot);
+
+/* Find the first open lot of the account for which match_func returns
+ * TRUE, looking only at lots whose opening split has the sign given by
+ * positive_opening. Lots are tried in order of the posted date of their
+ * opening split, the earliest first or the latest first if latest is
+ * TRUE. Zero-amount opening splits never match. */
+GNCLot * xaccAccountFindOpenLotByDate (Account *acc, gboolean positive_opening,
+                                       gboolean latest,
+                                       gboolean (*match_func)(GNCLot *lot,
+                                                              gpointer user_data),
+                                       gpointer user_data);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
@@ -381,18 +381,84 @@ recurrenceNextInstance(const Recurrence *r, const GDate *ref, GDate *next)
     }
 }
 
-/* Zero-based index */
+/* The date of period number period_num counting from the start date,
+   aligned and adjusted for weekends the same way as in step 2 of
+   recurrenceNextInstance. */
+static void
+recurrence_period_date(const Recurrence *r, guint period_num, GDate *date)
+{
+    const GDate *start = &r->start;
+
+    switch (r->ptype)
+    {
+    case PERIOD_WEEK:
+    case PERIOD_DAY:
+        *date = *start;
+        g_date_add_days(date, period_num * r->mult *
+                        (r->ptype == PERIOD_WEEK ? 7 : 1));
+        break;
+    case PERIOD_YEAR:
+    case PERIOD_MONTH:
+    case PERIOD_NTH_WEEKDAY:
+    case PERIOD_LAST_WEEKDAY:
+    case PERIOD_END_OF_MONTH:
+    {
+        guint dim, n_months;
+
+        n_months = period_num * r->mult * (r->ptype == PERIOD_YEAR ? 12 : 1);
+        g_date_set_dmy(date, 1, g_date_get_month(start),
+                       g_date_get_year(start));
+        g_date_add_months(date, n_months);
+
+        dim = g_date_get_days_in_month(g_date_get_month(date),
+                                       g_date_get_year(date));
+        if (r->ptype == PERIOD_LAST_WEEKDAY || r->ptype == PERIOD_NTH_WEEKDAY)
+        {
+            gint wdresult = nth_weekday_compare(start, date, r->ptype);
+            if (wdresult < 0)
+                g_date_subtract_days(date, -wdresult);
+            else
+                g_date_add_days(date, wdresult);
+        }
+        else if (r->ptype == PERIOD_END_OF_MONTH || g_date_get_day(start) >= dim)
+            g_date_set_day(date, dim);
+        else
+            g_date_set_day(date, g_date_get_day(start));
+
+        adjust_for_weekend(r->ptype, r->wadj, date);
+    }
+    break;
+    default:
+        g_date_clear(date, 1);
+        break;
+    }
+}
+
+/* Zero-based index.  Gives the same dates as stepping n times through
+   recurrenceNextInstance from the start date, but computes them
+   directly. */
 void
 recurrenceNthInstance(const Recurrence *r, guint n, GDate *date)
 {
-    GDate ref;
-    guint i;
+    GDate adjusted_start;
 
-    for (*date = ref = r->start, i = 0; i < n; i++)
+    *date = r->start;
+    if (n == 0 || !g_date_valid(&r->start))
+        return;
+    if (r->ptype == PERIOD_ONCE)
     {
-        recurrenceNextInstance(r, &ref, date);
-        ref = *date;
+        g_date_clear(date, 1);
+        return;
     }
+
+    /* A start date moved forward off a weekend is reached by the first
+       step, so the periods lag the steps by one. */
+    adjusted_start = r->start;
+    adjust_for_weekend(r->ptype, r->wadj, &adjusted_start);
+    if (g_date_compare(&adjusted_start, &r->start) > 0)
+        --n;
+
+    recurrence_period_date(r, n, date);
 }
 
 time64
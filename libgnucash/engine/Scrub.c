@@ -59,15 +59,157 @@
 static QofLogModule log_module = G_LOG_DOMAIN;
 
 /* ================================================================ */
+/* The tree-wide scrubs run in two phases.  The analysis phase walks
+ * every transaction below the starting account exactly once and asks
+ * a read-only predicate whether the transaction needs fixing.  The
+ * predicates touch nothing but the split, transaction, account and
+ * commodity fields, so that phase is split across worker threads.
+ * The repair phase then runs serially on the main thread over the
+ * flagged transactions only, using the normal edit API.
+ */
+
+/* Don't bother starting a thread for less than this many transactions. */
+#define SCRUB_MIN_TRANS_PER_THREAD 1000
+
+typedef gboolean (*TransCheckFunc) (const Transaction *trans, gpointer data);
+typedef void (*TransFixFunc) (Transaction *trans, Account *root);
+
+typedef struct
+{
+    GPtrArray *transactions;
+    guint8 *needs_scrub;
+    guint first;
+    guint last;
+    TransCheckFunc check;
+    gpointer data;
+} ScrubCheckChunk;
+
+static int
+collect_trans_helper (Transaction *trans, gpointer data)
+{
+    g_ptr_array_add ((GPtrArray*)data, trans);
+    return 0;
+}
+
+static gpointer
+scrub_check_thread (gpointer user_data)
+{
+    ScrubCheckChunk *chunk = user_data;
+    guint i;
+
+    for (i = chunk->first; i < chunk->last; i++)
+        chunk->needs_scrub[i] =
+            chunk->check (g_ptr_array_index (chunk->transactions, i),
+                          chunk->data);
+    return NULL;
+}
+
+/* Return the transactions in the tree rooted at acc for which check
+ * returns TRUE, in tree traversal order.  The caller owns the array. */
+static GPtrArray *
+scrub_find_transactions (Account *acc, TransCheckFunc check, gpointer data)
+{
+    GPtrArray *all = g_ptr_array_new ();
+    GPtrArray *found;
+    ScrubCheckChunk *chunks;
+    GThread **threads;
+    guint8 *needs_scrub;
+    guint n_threads, per_thread, i;
+
+    xaccAccountTreeForEachTransaction (acc, collect_trans_helper, all);
+
+    n_threads = MIN ((guint) g_get_num_processors (),
+                     all->len / SCRUB_MIN_TRANS_PER_THREAD);
+    n_threads = MAX (n_threads, 1);
+    per_thread = (all->len + n_threads - 1) / n_threads;
+
+    needs_scrub = g_new0 (guint8, all->len + 1);
+    chunks = g_new0 (ScrubCheckChunk, n_threads);
+    threads = g_new0 (GThread*, n_threads);
+    for (i = 0; i < n_threads; i++)
+    {
+        chunks[i].transactions = all;
+        chunks[i].needs_scrub = needs_scrub;
+        chunks[i].first = MIN (i * per_thread, all->len);
+        chunks[i].last = MIN (chunks[i].first + per_thread, all->len);
+        chunks[i].check = check;
+        chunks[i].data = data;
+    }
+
+    /* The calling thread takes the first chunk itself. */
+    for (i = 1; i < n_threads; i++)
+        threads[i] = g_thread_new ("scrub-check", scrub_check_thread,
+                                   &chunks[i]);
+    scrub_check_thread (&chunks[0]);
+    for (i = 1; i < n_threads; i++)
+        g_thread_join (threads[i]);
+
+    found = g_ptr_array_new ();
+    for (i = 0; i < all->len; i++)
+        if (needs_scrub[i])
+            g_ptr_array_add (found, g_ptr_array_index (all, i));
+
+    PINFO ("%u of %u transactions need scrubbing (%u threads)",
+           found->len, all->len, n_threads);
+
+    g_free (threads);
+    g_free (chunks);
+    g_free (needs_scrub);
+    g_ptr_array_free (all, TRUE);
+    return found;
+}
+
+static void
+scrub_fix_transactions (GPtrArray *transactions, Account *root,
+                        TransFixFunc fix, const char *message,
+                        QofPercentageFunc percentagefunc)
+{
+    guint i;
+
+    for (i = 0; i < transactions->len; i++)
+    {
+        if (percentagefunc && i % 100 == 0)
+        {
+            char *progress_msg = g_strdup_printf (message, i, transactions->len);
+            (percentagefunc)(progress_msg, (100 * i) / transactions->len);
+            g_free (progress_msg);
+        }
+        fix (g_ptr_array_index (transactions, i), root);
+    }
+    if (percentagefunc)
+        (percentagefunc)(NULL, -1.0);
+}
+
+/* ================================================================ */
+
+static void TransScrubOrphansFast (Transaction *trans, Account *root);
+
+static gboolean
+trans_has_orphans (const Transaction *trans, gpointer data)
+{
+    GList *node;
+
+    for (node = trans->splits; node; node = node->next)
+        if (!((Split*)node->data)->acc)
+            return TRUE;
+    return FALSE;
+}
 
 void
 xaccAccountTreeScrubOrphans (Account *acc, QofPercentageFunc percentagefunc)
 {
+    GPtrArray *orphaned;
+
     if (!acc) return;
 
-    xaccAccountScrubOrphans (acc, percentagefunc);
-    gnc_account_foreach_descendant(acc,
-                                   (AccountCb)xaccAccountScrubOrphans, percentagefunc);
+    ENTER ("(acc=%s)", xaccAccountGetName (acc));
+    orphaned = scrub_find_transactions (acc, trans_has_orphans, NULL);
+    scrub_fix_transactions (orphaned, gnc_account_get_root (acc),
+                            TransScrubOrphansFast,
+                            _("Looking for orphans: %u of %u"),
+                            percentagefunc);
+    g_ptr_array_free (orphaned, TRUE);
+    LEAVE ("(acc=%s)", xaccAccountGetName (acc));
 }
 
 static void
@@ -288,12 +430,98 @@ xaccSplitScrub (Split *split)
 
 /* ================================================================ */
 
+static gboolean
+trans_bad_currency (const Transaction *trans)
+{
+    return !trans->common_currency ||
+        !gnc_commodity_is_currency (trans->common_currency);
+}
+
+/* Read-only mirror of the conditions xaccTransScrubCurrency,
+ * xaccSplitScrub and xaccTransScrubImbalance repair.  It may report
+ * transactions that turn out to be fine, but must never miss one that
+ * the serial scrub would have changed.  data is non-NULL when the
+ * book uses trading accounts. */
+static gboolean
+trans_needs_imbalance_scrub (const Transaction *trans, gpointer data)
+{
+    gboolean use_trading = (data != NULL);
+    gnc_commodity *currency = trans->common_currency;
+    gnc_numeric imbal = gnc_numeric_zero ();
+    gnc_numeric imbal_trading = gnc_numeric_zero ();
+    GList *node;
+
+    if (trans_bad_currency (trans))
+        return TRUE;
+
+    for (node = trans->splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        gnc_commodity *acc_commodity;
+
+        if (!split->acc)
+            return TRUE;
+        if (gnc_numeric_check (split->value) ||
+            gnc_numeric_check (split->amount))
+            return TRUE;
+
+        acc_commodity = xaccAccountGetCommodity (split->acc);
+        if (!acc_commodity)
+            return TRUE;
+
+        if (gnc_commodity_equiv (acc_commodity, currency))
+        {
+            int scu = MIN (xaccAccountGetCommoditySCU (split->acc),
+                           gnc_commodity_get_fraction (currency));
+            if (!gnc_numeric_same (split->amount, split->value, scu,
+                                   GNC_HOW_RND_ROUND_HALF_UP))
+                return TRUE;
+        }
+        else if (use_trading)
+        {
+            /* Checking the per-commodity balance needs the trading
+             * splits; leave multi-commodity transactions to the serial
+             * scrub. */
+            return TRUE;
+        }
+
+        if (use_trading && xaccAccountGetType (split->acc) == ACCT_TYPE_TRADING)
+            imbal_trading = gnc_numeric_add (imbal_trading, split->value,
+                                             GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+        else
+            imbal = gnc_numeric_add (imbal, split->value,
+                                     GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    }
+
+    return !gnc_numeric_zero_p (imbal) || !gnc_numeric_zero_p (imbal_trading);
+}
+
+static void
+TransScrubImbalanceFast (Transaction *trans, Account *root)
+{
+    TransScrubOrphansFast (trans, root);
+    xaccTransScrubCurrency (trans);
+    xaccTransScrubImbalance (trans, root, NULL);
+}
+
 void
 xaccAccountTreeScrubImbalance (Account *acc, QofPercentageFunc percentagefunc)
 {
-    xaccAccountScrubImbalance (acc, percentagefunc);
-    gnc_account_foreach_descendant(acc,
-                                   (AccountCb)xaccAccountScrubImbalance, percentagefunc);
+    GPtrArray *unbalanced;
+    gboolean use_trading;
+
+    if (!acc) return;
+
+    ENTER ("(acc=%s)", xaccAccountGetName (acc));
+    use_trading = qof_book_use_trading_accounts (gnc_account_get_book (acc));
+    unbalanced = scrub_find_transactions (acc, trans_needs_imbalance_scrub,
+                                          use_trading ? GINT_TO_POINTER (1) : NULL);
+    scrub_fix_transactions (unbalanced, gnc_account_get_root (acc),
+                            TransScrubImbalanceFast,
+                            _("Looking for imbalances: %u of %u"),
+                            percentagefunc);
+    g_ptr_array_free (unbalanced, TRUE);
+    LEAVE ("(acc=%s)", xaccAccountGetName (acc));
 }
 
 void
@@ -1233,11 +1461,16 @@ xaccAccountDeleteOldData (Account *account)
     xaccAccountCommitEdit (account);
 }
 
-static int
-scrub_trans_currency_helper (Transaction *t, gpointer data)
+static gboolean
+trans_needs_currency_scrub (const Transaction *trans, gpointer data)
 {
-    xaccTransScrubCurrency (t);
-    return 0;
+    return trans_bad_currency (trans) || trans_has_orphans (trans, NULL);
+}
+
+static void
+scrub_trans_currency_helper (Transaction *trans, Account *root)
+{
+    xaccTransScrubCurrency (trans);
 }
 
 static void
@@ -1250,9 +1483,15 @@ scrub_account_commodity_helper (Account *account, gpointer data)
 void
 xaccAccountTreeScrubCommodities (Account *acc)
 {
+    GPtrArray *transactions;
+
     if (!acc) return;
 
-    xaccAccountTreeForEachTransaction (acc, scrub_trans_currency_helper, NULL);
+    transactions = scrub_find_transactions (acc, trans_needs_currency_scrub,
+                                            NULL);
+    scrub_fix_transactions (transactions, NULL, scrub_trans_currency_helper,
+                            NULL, NULL);
+    g_ptr_array_free (transactions, TRUE);
 
     scrub_account_commodity_helper (acc, NULL);
     gnc_account_foreach_descendant (acc, scrub_account_commodity_helper, NULL);
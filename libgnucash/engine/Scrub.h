@@ -80,7 +80,9 @@ void xaccTransScrubOrphans (Transaction *trans);
 void xaccAccountScrubOrphans (Account *acc, QofPercentageFunc percentagefunc);
 
 /** The xaccAccountTreeScrubOrphans() method performs this scrub for the
- *    indicated account and its children.
+ *    indicated account and its children.  Each transaction is examined
+ *    once; the search for orphans is spread over worker threads and only
+ *    the transactions that have orphans are then edited.
  */
 void xaccAccountTreeScrubOrphans (Account *acc, QofPercentageFunc percentagefunc);
 
@@ -109,6 +111,10 @@ void xaccAccountTreeScrubSplits (Account *account);
 void xaccTransScrubImbalance (Transaction *trans, Account *root,
                               Account *parent);
 void xaccAccountScrubImbalance (Account *acc, QofPercentageFunc percentagefunc);
+/** Like xaccAccountScrubImbalance(), for the account and its children.
+ *    Transactions that may need fixing are found on worker threads and
+ *    then scrubbed one at a time on the calling thread.
+ */
 void xaccAccountTreeScrubImbalance (Account *acc, QofPercentageFunc percentagefunc);
 
 /** The xaccTransScrubCurrency method fixes transactions without a
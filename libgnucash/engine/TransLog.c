@@ -28,6 +28,7 @@
 #include <errno.h>
 #include <glib.h>
 #include <glib/gstdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "Account.h"
@@ -89,6 +90,79 @@ static FILE * trans_log = NULL; /**< current log file handle */
 static char * trans_log_name = NULL; /**< current log file name */
 static char * log_base_name = NULL;
 
+/*
+ * Records are formatted by the committing thread and appended to
+ * log_buffer.  A writer thread waits for the first record, gives others
+ * LOG_FLUSH_INTERVAL to accumulate (or until LOG_FLUSH_SIZE bytes are
+ * pending), then writes and flushes them in one go.  xaccLogFlush(),
+ * xaccCloseLog() and process exit write out whatever is pending, so that
+ * at most LOG_FLUSH_INTERVAL worth of records is lost in a crash.
+ */
+#define LOG_FLUSH_INTERVAL (G_TIME_SPAN_SECOND / 4)
+#define LOG_FLUSH_SIZE (64 * 1024)
+
+static GMutex log_mutex;        /**< protects log_buffer and log_writer_stop */
+static GCond log_cond;
+static GString * log_buffer = NULL;
+static GMutex log_write_mutex;  /**< serializes writes to trans_log */
+static GString * log_write_buffer = NULL;
+static GThread * log_writer = NULL;
+static gboolean log_writer_stop = FALSE;
+
+/* Write out the pending records and flush the file. */
+static void
+log_write_pending (void)
+{
+    GString *pending;
+
+    g_mutex_lock (&log_write_mutex);
+    g_mutex_lock (&log_mutex);
+    pending = log_buffer;
+    log_buffer = log_write_buffer;
+    log_write_buffer = pending;
+    g_mutex_unlock (&log_mutex);
+
+    if (pending && pending->len > 0 && trans_log)
+    {
+        fwrite (pending->str, 1, pending->len, trans_log);
+        fflush (trans_log);
+    }
+    if (pending)
+        g_string_truncate (pending, 0);
+    g_mutex_unlock (&log_write_mutex);
+}
+
+static gpointer
+log_writer_thread (gpointer data)
+{
+    gint64 end_time;
+
+    g_mutex_lock (&log_mutex);
+    while (!log_writer_stop)
+    {
+        if (log_buffer->len == 0)
+        {
+            g_cond_wait (&log_cond, &log_mutex);
+            continue;
+        }
+        end_time = g_get_monotonic_time () + LOG_FLUSH_INTERVAL;
+        while (!log_writer_stop && log_buffer->len < LOG_FLUSH_SIZE &&
+               g_cond_wait_until (&log_cond, &log_mutex, end_time))
+            ;
+        g_mutex_unlock (&log_mutex);
+        log_write_pending ();
+        g_mutex_lock (&log_mutex);
+    }
+    g_mutex_unlock (&log_mutex);
+    return NULL;
+}
+
+static void
+log_close_at_exit (void)
+{
+    xaccCloseLog ();
+}
+
 /********************************************************************\
 \********************************************************************/
 
@@ -195,6 +269,13 @@ xaccOpenLog (void)
     g_free (filename);
     g_free (timestamp);
 
+    if (!log_buffer)
+    {
+        log_buffer = g_string_sized_new (LOG_FLUSH_SIZE);
+        log_write_buffer = g_string_sized_new (LOG_FLUSH_SIZE);
+        atexit (log_close_at_exit);
+    }
+
     /*  Note: this must match src/import-export/log-replay/gnc-log-replay.c */
     fprintf (trans_log, "mod\ttrans_guid\tsplit_guid\ttime_now\t"
              "date_entered\tdate_posted\t"
@@ -202,16 +283,35 @@ xaccOpenLog (void)
              "notes\tmemo\taction\treconciled\t"
              "amount\tvalue\tdate_reconciled\n");
     fprintf (trans_log, "-----------------\n");
+
+    log_writer = g_thread_new ("gnc-translog", log_writer_thread, NULL);
 }
 
 /********************************************************************\
 \********************************************************************/
 
+void
+xaccLogFlush (void)
+{
+    if (!trans_log) return;
+    log_write_pending ();
+}
+
 void
 xaccCloseLog (void)
 {
     if (!trans_log) return;
-    fflush (trans_log);
+    if (log_writer)
+    {
+        g_mutex_lock (&log_mutex);
+        log_writer_stop = TRUE;
+        g_cond_signal (&log_cond);
+        g_mutex_unlock (&log_mutex);
+        g_thread_join (log_writer);
+        log_writer = NULL;
+        log_writer_stop = FALSE;
+    }
+    log_write_pending ();
     fclose (trans_log);
     trans_log = NULL;
 }
@@ -227,6 +327,8 @@ xaccTransWriteLog (Transaction *trans, char flag)
     char split_guid_str[GUID_ENCODING_LENGTH + 1];
     const char *trans_notes;
     char dnow[100], dent[100], dpost[100], drecn[100];
+    GString *record;
+    gboolean wake_writer;
 
     if (!gen_logs)
     {
@@ -240,7 +342,8 @@ xaccTransWriteLog (Transaction *trans, char flag)
     gnc_time64_to_iso8601_buff (trans->date_posted, dpost);
     guid_to_string_buff (xaccTransGetGUID(trans), trans_guid_str);
     trans_notes = xaccTransGetNotes(trans);
-    fprintf (trans_log, "===== START\n");
+    record = g_string_sized_new (1024);
+    g_string_append (record, "===== START\n");
 
     for (node = trans->splits; node; node = node->next)
     {
@@ -268,7 +371,7 @@ xaccTransWriteLog (Transaction *trans, char flag)
         val = xaccSplitGetValue (split);
 
         /* use tab-separated fields */
-        fprintf (trans_log,
+        g_string_append_printf (record,
                  "%c\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t"
                  "%s\t%s\t%s\t%s\t%c\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%s\n",
                  flag,
@@ -294,10 +397,16 @@ xaccTransWriteLog (Transaction *trans, char flag)
                  drecn);
     }
 
-    fprintf (trans_log, "===== END\n");
+    g_string_append (record, "===== END\n");
 
-    /* get data out to the disk */
-    fflush (trans_log);
+    /* hand the record to the writer thread */
+    g_mutex_lock (&log_mutex);
+    wake_writer = (log_buffer->len == 0);
+    g_string_append_len (log_buffer, record->str, record->len);
+    if (wake_writer || log_buffer->len >= LOG_FLUSH_SIZE)
+        g_cond_signal (&log_cond);
+    g_mutex_unlock (&log_mutex);
+    g_string_free (record, TRUE);
 }
 
 /************************ END OF ************************************\
@@ -49,6 +49,10 @@
 void    xaccOpenLog (void);
 void    xaccCloseLog (void);
 void    xaccReopenLog (void);
+/** Write out the records still queued for the log file and flush it.
+ *  Records are otherwise written by a background thread shortly after
+ *  they are logged. */
+void    xaccLogFlush (void);
 
 /**
  * @param trans The transaction to write out to the log
@@ -1741,6 +1741,12 @@ xaccTransRollbackEdit (Transaction *trans)
 
     /* copy the original values back in. */
 
+    /* The lots of the edited splits may lose or change a split, and the
+     * posted date orders the lots, so their cached state must go; once
+     * for the lots the splits are in now, and again for the lots they
+     * are restored to below. */
+    FOR_EACH_SPLIT(trans, if (s->lot) gnc_lot_set_closed_unknown(s->lot));
+
     orig = trans->orig;
     SWAP(trans->num, orig->num);
     SWAP(trans->description, orig->description);
@@ -1811,6 +1817,8 @@ xaccTransRollbackEdit (Transaction *trans)
     g_list_free(orig->splits);
     orig->splits = NULL;
 
+    FOR_EACH_SPLIT(trans, if (s->lot) gnc_lot_set_closed_unknown(s->lot));
+
     /* Now that the engine copy is back to its original version,
      * get the backend to fix it in the database */
     be = qof_book_get_backend(qof_instance_get_book(trans));
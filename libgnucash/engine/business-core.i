@@ -115,6 +115,10 @@ GLIST_HELPER_INOUT(OwnerList, SWIGTYPE_p__gncOwner);
 #endif
 
 
+/* Lists of lots. */
+%ignore gncOwnerGetOpenLots;
+%ignore gncOwnerFindOpenLots;
+
 /* Parse the header files to generate wrappers */
 %include <gncAddress.h>
 %include <gncBillTerm.h>
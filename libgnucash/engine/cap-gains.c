@@ -102,88 +102,49 @@ xaccAccountHasTrades (const Account *acc)
 
 /* ============================================================== */
 
-struct find_lot_s
-{
-    GNCLot *lot;
-    gnc_commodity *currency;
-    time64 time;
-    int (*numeric_pred)(gnc_numeric);
-    gboolean (*date_pred)(time64 e, time64 tr);
-};
-
-static gboolean
-earliest_pred (time64 earl, time64 tran)
-{
-    return earl > tran;
-}
-
+/* Tests whether a candidate lot from the account's open lot index can
+ * take a split: the lot must be in the right currency and must not be
+ * overfull, i.e. its balance must still have the sign of its opening
+ * split. */
 static gboolean
-latest_pred (time64 earl, time64 tran)
-{
-    return earl < tran;
-}
-
-static gpointer
-finder_helper (GNCLot *lot,  gpointer user_data)
+open_lot_matches (GNCLot *lot, gpointer user_data)
 {
-    struct find_lot_s *els = user_data;
+    gnc_commodity *currency = user_data;
     Split *s;
     Transaction *trans;
     gnc_numeric bal;
     gboolean opening_is_positive, bal_is_positive;
-    time64 posted = 0;
-
-    if (gnc_lot_is_closed (lot)) return NULL;
 
     s = gnc_lot_get_earliest_split (lot);
-    if (s == NULL) return NULL;
+    if (s == NULL) return FALSE;
 
-    /* We want a lot whose balance is of the correct sign.  All splits
-       in a lot must be the opposite sign of the opening split.  We also
-       want to ignore lots that are overfull, i.e., where the balance in
-       the lot is of opposite sign to the opening split in the lot. */
-    if (0 == (els->numeric_pred) (s->amount)) return NULL;
     bal = gnc_lot_get_balance (lot);
     opening_is_positive = gnc_numeric_positive_p (s->amount);
     bal_is_positive = gnc_numeric_positive_p (bal);
-    if (opening_is_positive != bal_is_positive) return NULL;
+    if (opening_is_positive != bal_is_positive) return FALSE;
 
     trans = s->parent;
-    if (els->currency &&
-            (FALSE == gnc_commodity_equiv (els->currency,
+    if (currency &&
+            (FALSE == gnc_commodity_equiv (currency,
                                            trans->common_currency)))
     {
-        return NULL;
-    }
-
-    posted = trans->date_posted;
-    if (els->date_pred (els->time, posted))
-    {
-        els->time = trans->date_posted;
-        els->lot = lot;
+        return FALSE;
     }
 
-    return NULL;
+    return TRUE;
 }
 
 static inline GNCLot *
 xaccAccountFindOpenLot (Account *acc, gnc_numeric sign,
                         gnc_commodity *currency,
-                        gint64 guess,
-                        gboolean (*date_pred)(time64, time64))
+                        gboolean latest)
 {
-    struct find_lot_s es;
-
-    es.lot = NULL;
-    es.currency = currency;
-    es.time = guess;
-    es.date_pred = date_pred;
-
-    if (gnc_numeric_positive_p(sign)) es.numeric_pred = gnc_numeric_negative_p;
-    else es.numeric_pred = gnc_numeric_positive_p;
+    /* We want a lot whose balance is of the correct sign.  All splits
+       in a lot must be the opposite sign of the opening split. */
+    gboolean positive_opening = !gnc_numeric_positive_p (sign);
 
-    xaccAccountForEachLot (acc, finder_helper, &es);
-    return es.lot;
+    return xaccAccountFindOpenLotByDate (acc, positive_opening, latest,
+                                         open_lot_matches, currency);
 }
 
 GNCLot *
@@ -194,8 +155,7 @@ xaccAccountFindEarliestOpenLot (Account *acc, gnc_numeric sign,
     ENTER (" sign=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT, sign.num,
            sign.denom);
 
-    lot = xaccAccountFindOpenLot (acc, sign, currency,
-                                  G_MAXINT64, earliest_pred);
+    lot = xaccAccountFindOpenLot (acc, sign, currency, FALSE);
     LEAVE ("found lot=%p %s baln=%s", lot, gnc_lot_get_title (lot),
            gnc_num_dbg_to_string(gnc_lot_get_balance(lot)));
     return lot;
@@ -209,8 +169,7 @@ xaccAccountFindLatestOpenLot (Account *acc, gnc_numeric sign,
     ENTER (" sign=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
            sign.num, sign.denom);
 
-    lot = xaccAccountFindOpenLot (acc, sign, currency,
-                                  G_MININT64, latest_pred);
+    lot = xaccAccountFindOpenLot (acc, sign, currency, TRUE);
     LEAVE ("found lot=%p %s", lot, gnc_lot_get_title (lot));
     return lot;
 }
@@ -29,6 +29,7 @@
 #include <libguile.h>
 
 #include "gnc-engine.h"
+#include "Account.h"
 
 /* Helpers for various conversions to and from guile */
 
@@ -53,4 +54,12 @@ gnc_commodity * gnc_scm_to_commodity(SCM scm);
 SCM gnc_commodity_to_scm (const gnc_commodity *commodity);
 SCM gnc_book_to_scm (const QofBook *book);
 
+/* Returns a list of the summed balances of the accounts in the list
+ * accounts at each of the time64 values in dates, which are sorted
+ * first.  If report_commodity is a commodity the balances are
+ * converted to it, otherwise it should be #f. */
+SCM gnc_accounts_get_balances_at_dates (SCM accounts, SCM dates,
+                                        GNCAccountBalanceKind kind,
+                                        SCM report_commodity);
+
 #endif
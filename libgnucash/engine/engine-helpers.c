@@ -1988,3 +1988,50 @@ gnc_book_to_scm (const QofBook *book)
 {
     return gnc_generic_to_scm(book, "_p_QofBook");
 }
+
+static gint
+compare_time64 (gconstpointer a, gconstpointer b)
+{
+    time64 ta = *(const time64 *) a, tb = *(const time64 *) b;
+    return (ta > tb) - (ta < tb);
+}
+
+SCM
+gnc_accounts_get_balances_at_dates (SCM accounts, SCM dates,
+                                    GNCAccountBalanceKind kind,
+                                    SCM report_commodity)
+{
+    GList *acc_list = NULL;
+    GArray *date_array;
+    gnc_numeric *balances;
+    SCM result = SCM_EOL;
+    guint i;
+
+    for (; scm_is_pair (accounts); accounts = SCM_CDR (accounts))
+    {
+        Account *acc = gnc_scm_to_generic (SCM_CAR (accounts), "_p_Account");
+        if (acc)
+            acc_list = g_list_prepend (acc_list, acc);
+    }
+    acc_list = g_list_reverse (acc_list);
+
+    date_array = g_array_new (FALSE, FALSE, sizeof (time64));
+    for (; scm_is_pair (dates); dates = SCM_CDR (dates))
+    {
+        time64 date = scm_to_int64 (SCM_CAR (dates));
+        g_array_append_val (date_array, date);
+    }
+    g_array_sort (date_array, compare_time64);
+
+    balances = xaccAccountListGetBalancesAtDates
+        (acc_list, (time64 *) date_array->data, date_array->len, kind,
+         gnc_scm_to_commodity (report_commodity));
+
+    for (i = date_array->len; i > 0; i--)
+        result = scm_cons (gnc_numeric_to_scm (balances[i - 1]), result);
+
+    g_free (balances);
+    g_array_free (date_array, TRUE);
+    g_list_free (acc_list);
+    return result;
+}
@@ -226,6 +226,7 @@ SplitList * qof_query_run_subquery (QofQuery *q, const QofQuery *q);
 %ignore GNC_ERROR_OVERFLOW;
 %ignore GNC_ERROR_DENOM_DIFF;
 %ignore GNC_ERROR_REMAINDER;
+%ignore gnc_numeric_sum;
 %include <gnc-numeric.h>
 
 time64 time64CanonicalDayTime(time64 t);
@@ -320,6 +321,11 @@ void qof_book_set_string_option(QofBook* book, const char* opt_name, const char*
     SET_ENUM("ACCT-TYPE-MONEYMRKT");
     SET_ENUM("ACCT-TYPE-CREDITLINE");
 
+    SET_ENUM("ACCOUNT-BALANCE-TOTAL");
+    SET_ENUM("ACCOUNT-BALANCE-NOCLOSING");
+    SET_ENUM("ACCOUNT-BALANCE-CLEARED");
+    SET_ENUM("ACCOUNT-BALANCE-RECONCILED");
+
     SET_ENUM("QOF-QUERY-AND");
     SET_ENUM("QOF-QUERY-OR");
 
@@ -32,9 +32,12 @@
 #include <qofinstance-p.h>
 
 #include "Account.h"
+#include "Split.h"
+#include "Transaction.h"
 
 #include "gnc-budget.h"
 #include "gnc-commodity.h"
+#include "gnc-pricedb.h"
 
 static QofLogModule log_module = GNC_MOD_ENGINE;
 
@@ -71,6 +74,15 @@ typedef struct GncBudgetPrivate
 
     /* Number of periods */
     guint  num_periods;
+
+    /* Row caches keyed by Account*, see "Row caches" below. */
+    GHashTable *budget_rows;    /* BudgetCell[num_periods] */
+    GHashTable *balance_rows;   /* gnc_numeric[2 * num_periods] */
+    GHashTable *actual_rows;    /* gnc_numeric[num_periods] */
+    time64 *boundaries;         /* period start and end times, interleaved */
+    guint *boundary_order;      /* indices into boundaries by time */
+    gint event_handler_id;
+    guint dropped_events;
 } GncBudgetPrivate;
 
 #define GET_PRIVATE(o) \
@@ -81,6 +93,9 @@ struct _GncBudgetClass
     QofInstanceClass parent_class;
 };
 
+static void budget_cache_reset (GncBudgetPrivate *priv);
+static void budget_cache_destroy (GncBudgetPrivate *priv);
+
 /* GObject Initialization */
 G_DEFINE_TYPE_WITH_PRIVATE(GncBudget, gnc_budget, QOF_TYPE_INSTANCE)
 
@@ -262,6 +277,7 @@ gnc_budget_free(QofInstance *inst)
 
     CACHE_REMOVE(priv->name);
     CACHE_REMOVE(priv->description);
+    budget_cache_destroy(priv);
 
     /* qof_instance_release (&budget->inst); */
     g_object_unref(budget);
@@ -425,6 +441,7 @@ gnc_budget_set_recurrence(GncBudget *budget, const Recurrence *r)
 
     gnc_budget_begin_edit(budget);
     priv->recurrence = *r;
+    budget_cache_reset(priv);
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
@@ -458,6 +475,7 @@ gnc_budget_set_num_periods(GncBudget* budget, guint num_periods)
 
     gnc_budget_begin_edit(budget);
     priv->num_periods = num_periods;
+    budget_cache_reset(priv);
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
@@ -481,6 +499,288 @@ make_period_path (const Account *account, guint period_num, char *path1, char *p
     g_sprintf (path2, "%d", period_num);
 }
 
+/* Row caches
+ *
+ * The budget page and the budget reports ask for every cell of an
+ * accounts x periods grid, and ask again on every redraw.  Each cell
+ * would otherwise cost a KVP lookup or a walk over the splits of an
+ * account and all its descendants, so a whole row is built at once
+ * and kept until an event says it is stale:
+ *
+ * budget_rows holds the budgeted values read from the KVP, and is
+ * kept current by the setters below.
+ *
+ * balance_rows holds each account's own no-closing balance at the
+ * start and end of every period, built in one pass over its splits.
+ * It is dropped when the account or one of its splits changes.
+ *
+ * actual_rows holds the actual values, which add up the balance rows
+ * of an account and its descendants.  They are dropped when any of
+ * those changes, and all of them when a price or the account tree
+ * changes.
+ *
+ * If events were suspended while something changed, all the account
+ * rows are dropped the next time they are used.
+ */
+typedef struct
+{
+    gnc_numeric value;
+    gboolean is_set;
+} BudgetCell;
+
+static void
+budget_cache_reset (GncBudgetPrivate *priv)
+{
+    if (priv->budget_rows)
+    {
+        g_hash_table_remove_all (priv->budget_rows);
+        g_hash_table_remove_all (priv->balance_rows);
+        g_hash_table_remove_all (priv->actual_rows);
+    }
+    g_free (priv->boundaries);
+    g_free (priv->boundary_order);
+    priv->boundaries = NULL;
+    priv->boundary_order = NULL;
+}
+
+static void
+budget_cache_destroy (GncBudgetPrivate *priv)
+{
+    budget_cache_reset (priv);
+    if (priv->event_handler_id)
+        qof_event_unregister_handler (priv->event_handler_id);
+    priv->event_handler_id = 0;
+    if (priv->budget_rows)
+    {
+        g_hash_table_destroy (priv->budget_rows);
+        g_hash_table_destroy (priv->balance_rows);
+        g_hash_table_destroy (priv->actual_rows);
+    }
+    priv->budget_rows = priv->balance_rows = priv->actual_rows = NULL;
+}
+
+/* Drop the rows that depend on acc's splits. */
+static void
+budget_cache_invalidate_account (GncBudgetPrivate *priv, Account *acc)
+{
+    if (!acc)
+        return;
+    g_hash_table_remove (priv->balance_rows, acc);
+    for (; acc; acc = gnc_account_get_parent (acc))
+        g_hash_table_remove (priv->actual_rows, acc);
+}
+
+static void
+budget_cache_event_handler (QofInstance *ent, QofEventId event_type,
+                            gpointer user_data, gpointer event_data)
+{
+    GncBudgetPrivate *priv = GET_PRIVATE(user_data);
+
+    if (GNC_IS_ACCOUNT(ent))
+    {
+        if (event_type & (QOF_EVENT_CREATE | QOF_EVENT_DESTROY |
+                          QOF_EVENT_ADD | QOF_EVENT_REMOVE))
+        {
+            g_hash_table_remove (priv->budget_rows, ent);
+            g_hash_table_remove (priv->balance_rows, ent);
+            g_hash_table_remove_all (priv->actual_rows);
+        }
+        else
+            budget_cache_invalidate_account (priv, GNC_ACCOUNT(ent));
+    }
+    else if (GNC_IS_SPLIT(ent))
+        budget_cache_invalidate_account (priv, xaccSplitGetAccount (GNC_SPLIT(ent)));
+    else if (GNC_IS_TRANSACTION(ent))
+    {
+        GList *node;
+        for (node = xaccTransGetSplitList (GNC_TRANSACTION(ent)); node;
+             node = node->next)
+            budget_cache_invalidate_account (priv, xaccSplitGetAccount (node->data));
+    }
+    else if (GNC_IS_PRICE(ent))
+        g_hash_table_remove_all (priv->actual_rows);
+}
+
+static gint
+compare_boundaries (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+    const time64 *boundaries = user_data;
+    time64 ta = boundaries[*(const guint*)a], tb = boundaries[*(const guint*)b];
+    return (ta > tb) - (ta < tb);
+}
+
+static GncBudgetPrivate *
+budget_cache_check (const GncBudget *budget)
+{
+    GncBudgetPrivate *priv = GET_PRIVATE(budget);
+    guint dropped = qof_event_get_dropped_count ();
+    guint i;
+
+    if (!priv->budget_rows)
+    {
+        priv->budget_rows = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+        priv->balance_rows = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+        priv->actual_rows = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+        priv->event_handler_id =
+            qof_event_register_handler (budget_cache_event_handler,
+                                        (gpointer)budget);
+        priv->dropped_events = dropped;
+    }
+    else if (priv->dropped_events != dropped)
+    {
+        g_hash_table_remove_all (priv->balance_rows);
+        g_hash_table_remove_all (priv->actual_rows);
+        priv->dropped_events = dropped;
+    }
+
+    if (!priv->boundaries)
+    {
+        priv->boundaries = g_new (time64, 2 * priv->num_periods);
+        priv->boundary_order = g_new (guint, 2 * priv->num_periods);
+        for (i = 0; i < priv->num_periods; i++)
+        {
+            priv->boundaries[2 * i] =
+                recurrenceGetPeriodTime (&priv->recurrence, i, FALSE);
+            priv->boundaries[2 * i + 1] =
+                recurrenceGetPeriodTime (&priv->recurrence, i, TRUE);
+        }
+        for (i = 0; i < 2 * priv->num_periods; i++)
+            priv->boundary_order[i] = i;
+        g_qsort_with_data (priv->boundary_order, 2 * priv->num_periods,
+                           sizeof (guint), compare_boundaries,
+                           priv->boundaries);
+    }
+    return priv;
+}
+
+static BudgetCell *
+budget_cache_get_budget_row (const GncBudget *budget, const Account *account)
+{
+    GncBudgetPrivate *priv = budget_cache_check (budget);
+    gchar path_part_one [GUID_ENCODING_LENGTH + 1];
+    gchar path_part_two [GNC_BUDGET_MAX_NUM_PERIODS_DIGITS];
+    BudgetCell *row = g_hash_table_lookup (priv->budget_rows, account);
+    guint i;
+
+    if (row)
+        return row;
+
+    row = g_new0 (BudgetCell, priv->num_periods);
+    for (i = 0; i < priv->num_periods; i++)
+    {
+        GValue v = G_VALUE_INIT;
+        gnc_numeric *numeric = NULL;
+
+        make_period_path (account, i, path_part_one, path_part_two);
+        qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
+        if (G_VALUE_HOLDS_BOXED (&v))
+            numeric = (gnc_numeric*)g_value_get_boxed (&v);
+        row[i].is_set = (numeric != NULL);
+        row[i].value = numeric ? *numeric : gnc_numeric_zero ();
+        if (G_IS_VALUE (&v))
+            g_value_unset (&v);
+    }
+    g_hash_table_insert (priv->budget_rows, (gpointer)account, row);
+    return row;
+}
+
+/* The no-closing balance of the account alone before each period
+ * boundary, as xaccAccountGetNoclosingBalanceAsOfDate would return
+ * it, in one pass over the account's splits. */
+static gnc_numeric *
+budget_cache_get_balance_row (GncBudgetPrivate *priv, Account *acc)
+{
+    gnc_numeric *row = g_hash_table_lookup (priv->balance_rows, acc);
+    Split *latest = NULL;
+    GList *node;
+    guint i;
+
+    if (row)
+        return row;
+
+    node = xaccAccountGetSplitList (acc);
+    xaccAccountRecomputeBalance (acc);
+    row = g_new (gnc_numeric, 2 * priv->num_periods);
+    for (i = 0; i < 2 * priv->num_periods; i++)
+    {
+        guint b = priv->boundary_order[i];
+
+        for (; node; node = node->next)
+        {
+            Split *split = node->data;
+            if (xaccTransGetDate (xaccSplitGetParent (split)) >= priv->boundaries[b])
+                break;
+            latest = split;
+        }
+        row[b] = latest ? xaccSplitGetNoclosingBalance (latest) : gnc_numeric_zero ();
+    }
+    g_hash_table_insert (priv->balance_rows, acc, row);
+    return row;
+}
+
+/* Adds up the balance rows exactly as
+ * xaccAccountGetNoclosingBalanceChangeForPeriod does for one period. */
+static gnc_numeric *
+budget_cache_get_actual_row (const GncBudget *budget, Account *acc)
+{
+    GncBudgetPrivate *priv = budget_cache_check (budget);
+    gnc_numeric *row = g_hash_table_lookup (priv->actual_rows, acc);
+    gnc_commodity *commodity = xaccAccountGetCommodity (acc);
+    gnc_numeric *start, *end, *own;
+    GList *descendants, *node;
+    guint i, n = priv->num_periods;
+
+    if (row)
+        return row;
+
+    row = g_new (gnc_numeric, n);
+    if (!commodity)
+    {
+        for (i = 0; i < n; i++)
+            row[i] = gnc_numeric_zero ();
+        g_hash_table_insert (priv->actual_rows, acc, row);
+        return row;
+    }
+
+    start = g_new (gnc_numeric, n);
+    end = g_new (gnc_numeric, n);
+    own = budget_cache_get_balance_row (priv, acc);
+    for (i = 0; i < n; i++)
+    {
+        start[i] = own[2 * i];
+        end[i] = own[2 * i + 1];
+    }
+
+    descendants = gnc_account_get_descendants (acc);
+    for (node = descendants; node; node = node->next)
+    {
+        Account *child = node->data;
+        gnc_commodity *child_commodity = xaccAccountGetCommodity (child);
+        gnc_numeric *balances = budget_cache_get_balance_row (priv, child);
+
+        for (i = 0; i < n; i++)
+        {
+            start[i] = gnc_numeric_add (start[i], xaccAccountConvertBalanceToCurrency
+                                        (child, balances[2 * i], child_commodity, commodity),
+                                        gnc_commodity_get_fraction (commodity),
+                                        GNC_HOW_RND_ROUND_HALF_UP);
+            end[i] = gnc_numeric_add (end[i], xaccAccountConvertBalanceToCurrency
+                                      (child, balances[2 * i + 1], child_commodity, commodity),
+                                      gnc_commodity_get_fraction (commodity),
+                                      GNC_HOW_RND_ROUND_HALF_UP);
+        }
+    }
+    g_list_free (descendants);
+
+    for (i = 0; i < n; i++)
+        row[i] = gnc_numeric_sub (end[i], start[i], GNC_DENOM_AUTO,
+                                  GNC_HOW_DENOM_FIXED);
+    g_free (start);
+    g_free (end);
+    g_hash_table_insert (priv->actual_rows, acc, row);
+    return row;
+}
+
 /* period_num is zero-based */
 /* What happens when account is deleted, after we have an entry for it? */
 void
@@ -499,6 +799,18 @@ gnc_budget_unset_account_period_value(GncBudget *budget, const Account *account,
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
+    if (GET_PRIVATE(budget)->budget_rows &&
+        period_num < GET_PRIVATE(budget)->num_periods)
+    {
+        BudgetCell *row = g_hash_table_lookup (GET_PRIVATE(budget)->budget_rows,
+                                               account);
+        if (row)
+        {
+            row[period_num].is_set = FALSE;
+            row[period_num].value = gnc_numeric_zero ();
+        }
+    }
+
     qof_event_gen( &budget->inst, QOF_EVENT_MODIFY, NULL);
 
 }
@@ -538,6 +850,17 @@ gnc_budget_set_account_period_value(GncBudget *budget, const Account *account,
     qof_instance_set_dirty(&budget->inst);
     gnc_budget_commit_edit(budget);
 
+    if (GET_PRIVATE(budget)->budget_rows)
+    {
+        BudgetCell *row = g_hash_table_lookup (GET_PRIVATE(budget)->budget_rows,
+                                               account);
+        if (row)
+        {
+            row[period_num].is_set = !gnc_numeric_check (val);
+            row[period_num].value = row[period_num].is_set ? val : gnc_numeric_zero ();
+        }
+    }
+
     qof_event_gen( &budget->inst, QOF_EVENT_MODIFY, NULL);
 
 }
@@ -558,6 +881,9 @@ gnc_budget_is_account_period_value_set(const GncBudget *budget,
     g_return_val_if_fail(GNC_IS_BUDGET(budget), FALSE);
     g_return_val_if_fail(account, FALSE);
 
+    if (period_num < GET_PRIVATE(budget)->num_periods)
+        return budget_cache_get_budget_row (budget, account)[period_num].is_set;
+
     make_period_path (account, period_num, path_part_one, path_part_two);
     qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
     if (G_VALUE_HOLDS_BOXED (&v))
@@ -578,6 +904,9 @@ gnc_budget_get_account_period_value(const GncBudget *budget,
     g_return_val_if_fail(GNC_IS_BUDGET(budget), gnc_numeric_zero());
     g_return_val_if_fail(account, gnc_numeric_zero());
 
+    if (period_num < GET_PRIVATE(budget)->num_periods)
+        return budget_cache_get_budget_row (budget, account)[period_num].value;
+
     make_period_path (account, period_num, path_part_one, path_part_two);
     qof_instance_get_kvp (QOF_INSTANCE (budget), &v, 2, path_part_one, path_part_two);
     if (G_VALUE_HOLDS_BOXED (&v))
@@ -609,6 +938,8 @@ gnc_budget_get_account_period_actual_value(
 {
     // FIXME: maybe zero is not best error return val.
     g_return_val_if_fail(GNC_IS_BUDGET(budget) && acc, gnc_numeric_zero());
+    if (period_num < GET_PRIVATE(budget)->num_periods)
+        return budget_cache_get_actual_row (budget, acc)[period_num];
     return recurrenceGetAccountPeriodValue(&GET_PRIVATE(budget)->recurrence,
                                            acc, period_num);
 }
@@ -98,6 +98,8 @@ struct _GncCommodityClass
 };
 
 static void commodity_free(gnc_commodity * cm);
+static gnc_commodity_table *commodity_index_remove_for_change(gnc_commodity *cm);
+static void commodity_index_add(gnc_commodity_table *table, gnc_commodity *comm);
 static void gnc_commodity_set_default_symbol(gnc_commodity *, const char *);
 
 struct gnc_commodity_namespace_s
@@ -119,6 +121,14 @@ struct gnc_commodity_table_s
 {
     GHashTable * ns_table;
     GList      * ns_list;
+
+    /* Commodities by CUSIP and, per namespace, by printable name, built
+     * on the first lookup and then updated by the changes to the table
+     * and its commodities.  The values are GPtrArrays of the
+     * commodities sharing a key, indexed holds the commodities in them. */
+    GHashTable * cusip_index;
+    GHashTable * printname_index;
+    GHashTable * indexed;
 };
 
 struct gnc_new_iso_code
@@ -980,10 +990,14 @@ gnc_commodity_copy(gnc_commodity * dest, const gnc_commodity *src)
 {
     gnc_commodityPrivate* src_priv = GET_PRIVATE(src);
     gnc_commodityPrivate* dest_priv = GET_PRIVATE(dest);
+    gnc_commodity_table *table;
 
     gnc_commodity_set_fullname (dest, src_priv->fullname);
     gnc_commodity_set_mnemonic (dest, src_priv->mnemonic);
+    table = commodity_index_remove_for_change (dest);
     dest_priv->name_space = src_priv->name_space;
+    if (table)
+        commodity_index_add (table, dest);
     gnc_commodity_set_fraction (dest, src_priv->fraction);
     gnc_commodity_set_cusip (dest, src_priv->cusip);
     gnc_commodity_set_quote_flag (dest, src_priv->quote_flag);
@@ -1232,18 +1246,22 @@ void
 gnc_commodity_set_mnemonic(gnc_commodity * cm, const char * mnemonic)
 {
     gnc_commodityPrivate* priv;
+    gnc_commodity_table *table;
 
     if (!cm) return;
     priv = GET_PRIVATE(cm);
     if (priv->mnemonic == mnemonic) return;
 
     gnc_commodity_begin_edit(cm);
+    table = commodity_index_remove_for_change(cm);
     CACHE_REMOVE (priv->mnemonic);
     priv->mnemonic = CACHE_INSERT(mnemonic);
 
     mark_commodity_dirty (cm);
     reset_printname(priv);
     reset_unique_name(priv);
+    if (table)
+        commodity_index_add(table, cm);
     gnc_commodity_commit_edit(cm);
 }
 
@@ -1255,7 +1273,7 @@ void
 gnc_commodity_set_namespace(gnc_commodity * cm, const char * name_space)
 {
     QofBook *book;
-    gnc_commodity_table *table;
+    gnc_commodity_table *table, *indexed;
     gnc_commodity_namespace *nsp;
     gnc_commodityPrivate* priv;
 
@@ -1268,12 +1286,15 @@ gnc_commodity_set_namespace(gnc_commodity * cm, const char * name_space)
         return;
 
     gnc_commodity_begin_edit(cm);
+    indexed = commodity_index_remove_for_change(cm);
     priv->name_space = nsp;
     if (nsp->iso4217)
         priv->quote_source = gnc_quote_source_lookup_by_internal("currency");
     mark_commodity_dirty(cm);
     reset_printname(priv);
     reset_unique_name(priv);
+    if (indexed)
+        commodity_index_add(indexed, cm);
     gnc_commodity_commit_edit(cm);
 }
 
@@ -1285,17 +1306,21 @@ void
 gnc_commodity_set_fullname(gnc_commodity * cm, const char * fullname)
 {
     gnc_commodityPrivate* priv;
+    gnc_commodity_table *table;
 
     if (!cm) return;
     priv = GET_PRIVATE(cm);
     if (priv->fullname == fullname) return;
 
+    table = commodity_index_remove_for_change(cm);
     CACHE_REMOVE (priv->fullname);
     priv->fullname = CACHE_INSERT (fullname);
 
     gnc_commodity_begin_edit(cm);
     mark_commodity_dirty(cm);
     reset_printname(priv);
+    if (table)
+        commodity_index_add(table, cm);
     gnc_commodity_commit_edit(cm);
 }
 
@@ -1308,6 +1333,7 @@ gnc_commodity_set_cusip(gnc_commodity * cm,
                         const char * cusip)
 {
     gnc_commodityPrivate* priv;
+    gnc_commodity_table *table;
 
     if (!cm) return;
 
@@ -1315,8 +1341,11 @@ gnc_commodity_set_cusip(gnc_commodity * cm,
     if (priv->cusip == cusip) return;
 
     gnc_commodity_begin_edit(cm);
+    table = commodity_index_remove_for_change(cm);
     CACHE_REMOVE (priv->cusip);
     priv->cusip = CACHE_INSERT (cusip);
+    if (table)
+        commodity_index_add(table, cm);
     mark_commodity_dirty(cm);
     gnc_commodity_commit_edit(cm);
 }
@@ -1862,30 +1891,180 @@ gnc_commodity *
 gnc_commodity_table_lookup_unique(const gnc_commodity_table *table,
                                   const char * unique_name)
 {
+    char buf[64];
     char *name_space;
-    char *mnemonic;
+    const char *mnemonic;
     gnc_commodity *commodity;
+    gsize ns_len;
 
     if (!table || !unique_name) return NULL;
 
-    name_space = g_strdup (unique_name);
-    mnemonic = strstr (name_space, "::");
+    mnemonic = strstr (unique_name, "::");
     if (!mnemonic)
-    {
-        g_free (name_space);
         return NULL;
-    }
 
-    *mnemonic = '\0';
-    mnemonic += 2;
+    /* Namespaces are short, only copy long ones to the heap. */
+    ns_len = mnemonic - unique_name;
+    name_space = ns_len < sizeof (buf) ? buf : g_malloc (ns_len + 1);
+    memcpy (name_space, unique_name, ns_len);
+    name_space[ns_len] = '\0';
 
-    commodity = gnc_commodity_table_lookup (table, name_space, mnemonic);
+    commodity = gnc_commodity_table_lookup (table, name_space, mnemonic + 2);
 
-    g_free (name_space);
+    if (name_space != buf)
+        g_free (name_space);
 
     return commodity;
 }
 
+/********************************************************************
+ * Lookup indexes
+ ********************************************************************/
+
+/* Add comm to the commodities under key in index. */
+static void
+commodity_index_insert (GHashTable *index, const char *key, gnc_commodity *comm)
+{
+    GPtrArray *comms = g_hash_table_lookup (index, key);
+
+    if (!comms)
+    {
+        comms = g_ptr_array_new ();
+        g_hash_table_insert (index, g_strdup (key), comms);
+    }
+    g_ptr_array_add (comms, comm);
+}
+
+static void
+commodity_index_erase (GHashTable *index, const char *key, gnc_commodity *comm)
+{
+    GPtrArray *comms = g_hash_table_lookup (index, key);
+
+    if (!comms)
+        return;
+    g_ptr_array_remove (comms, comm);
+    if (comms->len == 0)
+        g_hash_table_remove (index, key);
+}
+
+/* The first of the commodities under key in index. */
+static gnc_commodity *
+commodity_index_lookup (GHashTable *index, const char *key)
+{
+    GPtrArray *comms = index ? g_hash_table_lookup (index, key) : NULL;
+    return comms ? g_ptr_array_index (comms, 0) : NULL;
+}
+
+/* Add comm to the lookup indexes of table, if it has them, under its
+ * current CUSIP, namespace and printable name. */
+static void
+commodity_index_add (gnc_commodity_table *table, gnc_commodity *comm)
+{
+    gnc_commodityPrivate *priv = GET_PRIVATE(comm);
+    const char *ns_name;
+    GHashTable *printnames;
+
+    if (!table->indexed || g_hash_table_contains (table->indexed, comm))
+        return;
+    g_hash_table_add (table->indexed, comm);
+
+    if (priv->cusip && *priv->cusip)
+        commodity_index_insert (table->cusip_index, priv->cusip, comm);
+
+    ns_name = gnc_commodity_namespace_get_name (priv->name_space);
+    if (!ns_name)
+        return;
+    printnames = g_hash_table_lookup (table->printname_index, ns_name);
+    if (!printnames)
+    {
+        printnames = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                            (GDestroyNotify)g_ptr_array_unref);
+        g_hash_table_insert (table->printname_index, g_strdup (ns_name),
+                             printnames);
+    }
+    commodity_index_insert (printnames, gnc_commodity_get_printname (comm),
+                            comm);
+}
+
+/* Take comm out of the lookup indexes of table.  This must be done
+ * before any of the keys it is indexed under change. */
+static gboolean
+commodity_index_remove (gnc_commodity_table *table, gnc_commodity *comm)
+{
+    gnc_commodityPrivate *priv = GET_PRIVATE(comm);
+    const char *ns_name;
+    GHashTable *printnames;
+
+    if (!table->indexed || !g_hash_table_remove (table->indexed, comm))
+        return FALSE;
+
+    if (priv->cusip && *priv->cusip)
+        commodity_index_erase (table->cusip_index, priv->cusip, comm);
+
+    ns_name = gnc_commodity_namespace_get_name (priv->name_space);
+    printnames = ns_name ?
+        g_hash_table_lookup (table->printname_index, ns_name) : NULL;
+    if (printnames)
+        commodity_index_erase (printnames, gnc_commodity_get_printname (comm),
+                               comm);
+    return TRUE;
+}
+
+/* Called by the setters of the indexed fields before they change one.
+ * Returns the table to add cm back to afterwards, if any. */
+static gnc_commodity_table *
+commodity_index_remove_for_change (gnc_commodity *cm)
+{
+    gnc_commodity_table *table =
+        gnc_commodity_table_get_table (qof_instance_get_book (&cm->inst));
+
+    return table && commodity_index_remove (table, cm) ? table : NULL;
+}
+
+static void
+commodity_table_index_commodity (gpointer key, gpointer value, gpointer data)
+{
+    commodity_index_add (data, value);
+}
+
+/* Build the lookup indexes of table on its first lookup. */
+static void
+commodity_table_build_index (gnc_commodity_table *table)
+{
+    GList *node;
+
+    if (table->indexed)
+        return;
+
+    table->indexed = g_hash_table_new (g_direct_hash, g_direct_equal);
+    table->cusip_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                (GDestroyNotify)g_ptr_array_unref);
+    table->printname_index = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                    g_free,
+                                                    (GDestroyNotify)g_hash_table_destroy);
+    for (node = table->ns_list; node; node = node->next)
+    {
+        gnc_commodity_namespace *ns = node->data;
+        g_hash_table_foreach (ns->cm_table, commodity_table_index_commodity,
+                              table);
+    }
+}
+
+/********************************************************************
+ * gnc_commodity_table_lookup_by_cusip
+ * locate a commodity by its CUSIP or other exchange code.
+ ********************************************************************/
+
+gnc_commodity *
+gnc_commodity_table_lookup_by_cusip(const gnc_commodity_table * table,
+                                    const char * cusip)
+{
+    if (!table || !cusip || !*cusip) return NULL;
+
+    commodity_table_build_index ((gnc_commodity_table*)table);
+    return commodity_index_lookup (table->cusip_index, cusip);
+}
+
 /********************************************************************
  * gnc_commodity_table_find_full
  * locate a commodity by namespace and printable name
@@ -1897,25 +2076,34 @@ gnc_commodity_table_find_full(const gnc_commodity_table * table,
                               const char * fullname)
 {
     gnc_commodity * retval = NULL;
-    GList         * all;
-    GList         * iterator;
+    GHashTable    * printnames;
+    GList         * node;
 
-    if (!fullname || (fullname[0] == '\0'))
+    if (!table || !fullname || (fullname[0] == '\0'))
         return NULL;
 
-    all = gnc_commodity_table_get_commodities(table, name_space);
+    commodity_table_build_index ((gnc_commodity_table*)table);
 
-    for (iterator = all; iterator; iterator = iterator->next)
+    if (g_strcmp0(name_space, GNC_COMMODITY_NS_NONCURRENCY) != 0)
     {
-        if (!strcmp(fullname,
-                    gnc_commodity_get_printname(iterator->data)))
-        {
-            retval = iterator->data;
-            break;
-        }
+        gnc_commodity_namespace *ns =
+            gnc_commodity_table_find_namespace(table, name_space);
+        if (!ns)
+            return NULL;
+        printnames = g_hash_table_lookup (table->printname_index, ns->name);
+        return commodity_index_lookup (printnames, fullname);
     }
 
-    g_list_free (all);
+    for (node = table->ns_list; node && !retval; node = node->next)
+    {
+        gnc_commodity_namespace *ns = node->data;
+
+        if (g_strcmp0(ns->name, GNC_COMMODITY_NS_CURRENCY) == 0
+            || g_strcmp0(ns->name, GNC_COMMODITY_NS_TEMPLATE) == 0)
+            continue;
+        printnames = g_hash_table_lookup (table->printname_index, ns->name);
+        retval = commodity_index_lookup (printnames, fullname);
+    }
 
     return retval;
 }
@@ -1996,6 +2184,7 @@ gnc_commodity_table_insert(gnc_commodity_table * table,
                         CACHE_INSERT(priv->mnemonic),
                         (gpointer)comm);
     nsp->cm_list = g_list_append(nsp->cm_list, comm);
+    commodity_index_add (table, comm);
 
     qof_event_gen (&comm->inst, QOF_EVENT_ADD, NULL);
     LEAVE ("(table=%p, comm=%p)", table, comm);
@@ -2019,6 +2208,10 @@ gnc_commodity_table_remove(gnc_commodity_table * table,
     if (!table) return;
     if (!comm) return;
 
+    /* Whether or not it is still in its namespace, comm must not stay in
+     * the lookup indexes. */
+    commodity_index_remove (table, comm);
+
     priv = GET_PRIVATE(comm);
     ns_name = gnc_commodity_namespace_get_name(priv->name_space);
     c = gnc_commodity_table_lookup (table, ns_name, priv->mnemonic);
@@ -2455,6 +2648,12 @@ gnc_commodity_table_destroy(gnc_commodity_table * t)
     t->ns_list = NULL;
     g_hash_table_destroy(t->ns_table);
     t->ns_table = NULL;
+    if (t->indexed)
+    {
+        g_hash_table_destroy(t->indexed);
+        g_hash_table_destroy(t->cusip_index);
+        g_hash_table_destroy(t->printname_index);
+    }
     LEAVE ("table=%p", t);
     g_free(t);
 }
@@ -749,6 +749,11 @@ gnc_commodity_table_lookup_unique(const gnc_commodity_table *table,
 gnc_commodity * gnc_commodity_table_find_full(const gnc_commodity_table * t,
         const char * commodity_namespace,
         const char * fullname);
+/** Find the commodity whose CUSIP (or other exchange code) is cusip.
+ *  If several have it, any of them may be returned.
+ *  @return The commodity or NULL if there is none. */
+gnc_commodity * gnc_commodity_table_lookup_by_cusip(const gnc_commodity_table * table,
+        const char * cusip);
 
 /*@ dependent @*/
 gnc_commodity * gnc_commodity_find_commodity_by_guid(const GncGUID *guid,
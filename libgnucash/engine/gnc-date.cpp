@@ -116,6 +116,8 @@ gnc_localtime (const time64 *secs)
 struct tm*
 gnc_localtime_r (const time64 *secs, struct tm* time)
 {
+    if (gnc_datetime_local_tm (*secs, *time))
+        return time;
     try
     {
         *time = static_cast<struct tm>(GncDateTime(*secs));
@@ -231,7 +233,11 @@ gnc_mktime (struct tm* time)
 {
     try
     {
+        time64 secs;
         normalize_struct_tm (time);
+        if (gnc_datetime_local_time64 (*time, secs) &&
+            gnc_datetime_local_tm (secs, *time))
+            return secs;
         GncDateTime gncdt(*time);
         *time = static_cast<struct tm>(gncdt);
         return static_cast<time64>(gncdt);
@@ -1215,12 +1221,22 @@ gnc_dmy2time64_neutral (int day, int month, int year)
 GDate time64_to_gdate (time64 t)
 {
     GDate result;
+    struct tm tm;
 
     g_date_clear (&result, 1);
-    GncDateTime time(t);
-    auto date = time.date().year_month_day();
-    g_date_set_dmy (&result, date.day, static_cast<GDateMonth>(date.month),
-                    date.year);
+    if (gnc_datetime_local_tm (t, tm))
+    {
+        g_date_set_dmy (&result, tm.tm_mday,
+                        static_cast<GDateMonth>(tm.tm_mon + 1),
+                        tm.tm_year + 1900);
+    }
+    else
+    {
+        GncDateTime time(t);
+        auto date = time.date().year_month_day();
+        g_date_set_dmy (&result, date.day, static_cast<GDateMonth>(date.month),
+                        date.year);
+    }
     g_assert(g_date_valid (&result));
 
     return result;
@@ -34,8 +34,12 @@ extern "C"
 #include <boost/regex.hpp>
 #include <libintl.h>
 #include <locale.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -213,16 +217,295 @@ LDT_from_struct_tm(const struct tm tm)
 
 using TD = boost::posix_time::time_duration;
 
+/* Days since 1970-01-01 of a proleptic Gregorian date and back, with
+ * plain integer arithmetic. See
+ * http://howardhinnant.github.io/date_algorithms.html
+ */
+static constexpr int64_t seconds_per_day = INT64_C(86400);
+
+static int64_t
+days_from_civil(int64_t year, unsigned int month, unsigned int day) noexcept
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const auto yoe = static_cast<unsigned int>(year - era * 400);
+    const unsigned int doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5
+        + day - 1;
+    const unsigned int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+static void
+civil_from_days(int64_t days, int& year, unsigned int& month,
+                unsigned int& day) noexcept
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const auto doe = static_cast<unsigned int>(days - era * 146097);
+    const unsigned int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned int mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int>(static_cast<int64_t>(yoe) + era * 400 + (month <= 2));
+}
+
+static time64
+time64_from_ptime(const PTime& ptime)
+{
+    return (ptime - unix_epoch).ticks() / ticks_per_second;
+}
+
+/** The UTC offsets of a TimeZoneProvider flattened into a sorted table of
+ * transitions, so that converting between UTC and local time needs a
+ * binary search instead of building boost::local_time objects.
+ *
+ * Each entry's offset is obtained from LDT_from_unix_local at the start
+ * of its interval, so lookups agree with GncDateTime. The candidate
+ * transition instants are the DST rule changes of each year, the
+ * midnights around them and the year boundaries, where TimeZoneProvider
+ * may switch rules.
+ */
+class OffsetTable
+{
+public:
+    OffsetTable(const TimeZoneProvider* provider);
+    bool lookup(time64 time, long& offset, bool& is_dst) const noexcept;
+    bool local_to_utc(time64 local, time64& time) const noexcept;
+    const TimeZoneProvider* provider() const noexcept { return m_provider; }
+    static constexpr int first_year = 1900;
+    static constexpr int last_year = 2200; // Exclusive
+private:
+    struct Transition
+    {
+        time64 start;
+        int32_t offset;
+        bool is_dst;
+    };
+    void add(time64 start);
+    const TimeZoneProvider* m_provider;
+    std::vector<Transition> m_transitions;
+    time64 m_end;
+};
+
+OffsetTable::OffsetTable(const TimeZoneProvider* provider) :
+    m_provider{provider}, m_end{0}
+{
+    std::vector<time64> candidates;
+    try
+    {
+        for (int year = first_year; year < last_year; ++year)
+        {
+            auto tz = provider->get(year);
+            auto year_start = days_from_civil(year, 1, 1) * seconds_per_day;
+            auto year_end = days_from_civil(year + 1, 1, 1) * seconds_per_day;
+            auto base = tz->base_utc_offset().total_seconds();
+            auto push = [&](time64 when) {
+                if (when >= year_start && when < year_end)
+                    candidates.push_back(when);
+            };
+            push(year_start);
+            /* Boost decides DST from the year of the standard local time,
+             * which can differ from the UTC year used to select tz. */
+            for (int rule_year = year - 1; rule_year <= year + 1; ++rule_year)
+            {
+                push(days_from_civil(rule_year, 1, 1) * seconds_per_day - base);
+                if (!tz->has_dst())
+                    continue;
+                auto dst_len = tz->dst_offset().total_seconds();
+                auto dst_start = time64_from_ptime(tz->dst_local_start_time(rule_year));
+                auto dst_end = time64_from_ptime(tz->dst_local_end_time(rule_year));
+                push(dst_start - base);
+                push(dst_end - base - dst_len);
+                // Boost compares in whole minutes; 1916 Dublin isn't.
+                push(dst_end - base - dst_len / 60 * 60);
+                /* Boost's day-granular DST test can also flip at the
+                 * midnights around the rule dates, e.g. a DST end before
+                 * 01:00 keeps the whole end day in DST. */
+                for (auto rule_time : {dst_start, dst_end})
+                {
+                    auto midnight = rule_time - (rule_time % seconds_per_day
+                                                 + seconds_per_day) % seconds_per_day;
+                    push(midnight - base);
+                    push(midnight + seconds_per_day - base);
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                         candidates.end());
+        for (auto when : candidates)
+            add(when);
+        m_end = days_from_civil(last_year, 1, 1) * seconds_per_day;
+    }
+    catch(const std::exception& err)
+    {
+        PWARN("Unable to tabulate the time zone, using the slow path: %s",
+              err.what());
+        m_transitions.clear();
+        m_end = 0;
+    }
+}
+
+void
+OffsetTable::add(time64 start)
+{
+    auto ldt = LDT_from_unix_local(start);
+    auto offset = static_cast<int32_t>((ldt.local_time() - ldt.utc_time()).total_seconds());
+    auto is_dst = ldt.is_dst();
+    if (!m_transitions.empty() && m_transitions.back().offset == offset &&
+        m_transitions.back().is_dst == is_dst)
+        return;
+    m_transitions.push_back({start, offset, is_dst});
+}
+
+bool
+OffsetTable::lookup(time64 time, long& offset, bool& is_dst) const noexcept
+{
+    if (m_transitions.empty() || time < m_transitions.front().start ||
+        time >= m_end)
+        return false;
+    auto next = std::upper_bound(m_transitions.begin(), m_transitions.end(), time,
+                                 [](time64 t, const Transition& tr) {
+                                     return t < tr.start; });
+    auto& entry = *(next - 1);
+    offset = entry.offset;
+    is_dst = entry.is_dst;
+    return true;
+}
+
+/* Only succeeds when exactly one UTC time has the given local time. Local
+ * times that are skipped or repeated by a transition are left to
+ * LDT_from_struct_tm, which has its own rules for them. */
+bool
+OffsetTable::local_to_utc(time64 local, time64& time) const noexcept
+{
+    constexpr time64 max_offset = 26 * 3600;
+    if (m_transitions.empty())
+        return false;
+    auto begin = std::upper_bound(m_transitions.begin(), m_transitions.end(),
+                                  local - max_offset,
+                                  [](time64 t, const Transition& tr) {
+                                      return t < tr.start; });
+    if (begin == m_transitions.begin())
+        return false;
+    --begin;
+    unsigned int matches = 0;
+    time64 result = 0;
+    for (auto iter = begin; iter != m_transitions.end() &&
+             iter->start <= local + max_offset; ++iter)
+    {
+        auto candidate = local - iter->offset;
+        auto next = iter + 1;
+        auto end = next == m_transitions.end() ? m_end : next->start;
+        if (candidate >= iter->start && candidate < end)
+        {
+            result = candidate;
+            ++matches;
+        }
+    }
+    if (matches != 1 || result >= m_end)
+        return false;
+    time = result;
+    return true;
+}
+
+static std::atomic<const OffsetTable*> offset_table{nullptr};
+static std::mutex offset_table_mutex;
+
+static const OffsetTable*
+get_offset_table()
+{
+    auto table = offset_table.load(std::memory_order_acquire);
+    if (table && table->provider() == tzp)
+        return table;
+
+    std::lock_guard<std::mutex> lock(offset_table_mutex);
+    /* Tables are kept until exit: a concurrent reader may still be
+     * using one built for a provider that has since been replaced. */
+    static std::vector<std::unique_ptr<OffsetTable>> tables;
+    table = offset_table.load(std::memory_order_acquire);
+    if (table && table->provider() == tzp)
+        return table;
+    tables.emplace_back(new OffsetTable(tzp));
+    table = tables.back().get();
+    offset_table.store(table, std::memory_order_release);
+    return table;
+}
+
 void
 _set_tzp(TimeZoneProvider& new_tzp)
 {
     tzp = &new_tzp;
+    offset_table.store(nullptr, std::memory_order_release);
 }
 
 void
 _reset_tzp()
 {
     tzp = &ltzp;
+    offset_table.store(nullptr, std::memory_order_release);
+}
+
+bool
+gnc_datetime_local_tm(time64 time, struct tm& tm) noexcept
+{
+    long offset;
+    bool is_dst;
+    if (!get_offset_table()->lookup(time, offset, is_dst))
+        return false;
+
+    auto local = time + offset;
+    auto days = local / seconds_per_day;
+    auto secs = local % seconds_per_day;
+    if (secs < 0)
+    {
+        secs += seconds_per_day;
+        --days;
+    }
+    int year;
+    unsigned int month, day;
+    civil_from_days(days, year, month, day);
+
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = secs / 3600;
+    tm.tm_min = secs % 3600 / 60;
+    tm.tm_sec = secs % 60;
+    tm.tm_wday = static_cast<int>(((days + 4) % 7 + 7) % 7); // 1970-01-01 was a Thursday
+    tm.tm_yday = static_cast<int>(days - days_from_civil(year, 1, 1));
+    tm.tm_isdst = is_dst ? 1 : 0;
+#if HAVE_STRUCT_TM_GMTOFF
+    tm.tm_gmtoff = offset;
+#endif
+    return true;
+}
+
+bool
+gnc_datetime_local_time64(const struct tm& tm, time64& time) noexcept
+{
+    if (tm.tm_mon < 0 || tm.tm_mon > 11 || tm.tm_mday < 1 || tm.tm_mday > 31 ||
+        tm.tm_hour < 0 || tm.tm_hour > 23 || tm.tm_min < 0 || tm.tm_min > 59 ||
+        tm.tm_sec < 0 || tm.tm_sec > 59)
+        return false;
+    /* LDT_from_struct_tm picks the zone rules by the local year, the
+     * table by the UTC year; leave the days where they can differ to it. */
+    if ((tm.tm_mon == 0 && tm.tm_mday == 1) || (tm.tm_mon == 11 && tm.tm_mday == 31))
+        return false;
+    auto year = static_cast<int64_t>(tm.tm_year) + 1900;
+    if (year < OffsetTable::first_year || year >= OffsetTable::last_year)
+        return false;
+
+    auto days = days_from_civil(year, tm.tm_mon + 1, tm.tm_mday);
+    if (tm.tm_mday > 28 &&
+        days >= days_from_civil(year, tm.tm_mon + 2, 1))
+        return false; // No such day, let boost complain.
+
+    auto local = days * seconds_per_day
+        + tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec;
+    return get_offset_table()->local_to_utc(local, time);
 }
 
 class GncDateTimeImpl
@@ -161,6 +161,20 @@ private:
     std::unique_ptr<GncDateTimeImpl> m_impl;
 };
 
+/** Fast conversions between time64 and local calendar time.
+ *
+ * These give the same results as GncDateTime for the current timezone,
+ * but use a precomputed table of the zone's UTC-offset transitions
+ * covering 1900 to 2199 instead of constructing boost::local_time
+ * objects. They return false without touching their output when they
+ * can't answer, in which case the caller must use GncDateTime.
+ */
+/** Fill @a tm as GncDateTime(time) cast to struct tm would. */
+bool gnc_datetime_local_tm(time64 time, struct tm& tm) noexcept;
+/** Convert a normalized local @a tm to a time64 as GncDateTime(tm)
+ * would. Fails for local times skipped or repeated by a DST transition. */
+bool gnc_datetime_local_time64(const struct tm& tm, time64& time) noexcept;
+
 /** GnuCash DateFormat class
  *
  * A helper class to represent a date format understood
@@ -90,6 +90,12 @@ typedef struct GNCLotPrivate
     signed char is_closed;
 #define LOT_CLOSED_UNKNOWN (-1)
 
+    /* Cached sum of the amounts of the splits in the lot. Only valid if
+     * balance_valid is TRUE. It's kept up to date when splits are added
+     * or removed and recomputed when a split in the lot is edited. */
+    gnc_numeric balance;
+    gboolean balance_valid;
+
     /* traversal marker, handy for preventing recursion */
     unsigned char marker;
 } GNCLotPrivate;
@@ -113,6 +119,8 @@ gnc_lot_init(GNCLot* lot)
     priv->account = NULL;
     priv->splits = NULL;
     priv->is_closed = LOT_CLOSED_UNKNOWN;
+    priv->balance = gnc_numeric_zero ();
+    priv->balance_valid = FALSE;
     priv->marker = 0;
 }
 
@@ -397,6 +405,9 @@ gnc_lot_set_closed_unknown(GNCLot* lot)
     {
         priv = GET_PRIVATE(lot);
         priv->is_closed = LOT_CLOSED_UNKNOWN;
+        priv->balance_valid = FALSE;
+        if (priv->account)
+            xaccAccountLotChanged (priv->account, lot);
     }
 }
 
@@ -477,6 +488,8 @@ gnc_lot_get_balance (GNCLot *lot)
     GList *node;
     gnc_numeric zero = gnc_numeric_zero();
     gnc_numeric baln = zero;
+    gnc_numeric *amounts;
+    guint n_amounts = 0;
     if (!lot) return zero;
 
     priv = GET_PRIVATE(lot);
@@ -486,16 +499,25 @@ gnc_lot_get_balance (GNCLot *lot)
         return zero;
     }
 
+    if (priv->balance_valid)
+    {
+        if (0 > priv->is_closed)
+            priv->is_closed = gnc_numeric_zero_p (priv->balance);
+        return priv->balance;
+    }
+
     /* Sum over splits; because they all belong to same account
      * they will have same denominator.
      */
+    amounts = g_new (gnc_numeric, g_list_length (priv->splits));
     for (node = priv->splits; node; node = node->next)
-    {
-        Split *s = node->data;
-        gnc_numeric amt = xaccSplitGetAmount (s);
-        baln = gnc_numeric_add_fixed (baln, amt);
-        g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
-    }
+        amounts[n_amounts++] = xaccSplitGetAmount (node->data);
+    baln = gnc_numeric_sum (amounts, n_amounts, GNC_DENOM_AUTO,
+                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+    g_free (amounts);
+    g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
+    priv->balance = baln;
+    priv->balance_valid = TRUE;
 
     /* cache a zero balance as a closed lot */
     if (gnc_numeric_equal (baln, zero))
@@ -562,6 +584,23 @@ gnc_lot_get_balance_before (const GNCLot *lot, const Split *split,
 
 /* ============================================================= */
 
+/* Keep the cached lot balance up to date when a split with the given
+ * amount is added to or removed from the lot. */
+static void
+lot_balance_update (GNCLotPrivate *priv, gnc_numeric amount, gboolean remove)
+{
+    if (!priv->balance_valid)
+        return;
+
+    if (remove)
+        priv->balance = gnc_numeric_sub_fixed (priv->balance, amount);
+    else
+        priv->balance = gnc_numeric_add_fixed (priv->balance, amount);
+
+    if (gnc_numeric_check (priv->balance) != GNC_ERROR_OK)
+        priv->balance_valid = FALSE;
+}
+
 void
 gnc_lot_add_split (GNCLot *lot, Split *split)
 {
@@ -608,6 +647,9 @@ gnc_lot_add_split (GNCLot *lot, Split *split)
 
     /* for recomputation of is-closed */
     priv->is_closed = LOT_CLOSED_UNKNOWN;
+    lot_balance_update (priv, split->amount, FALSE);
+    if (priv->account)
+        xaccAccountLotChanged (priv->account, lot);
     gnc_lot_commit_edit(lot);
 
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_MODIFY, NULL);
@@ -624,6 +666,8 @@ gnc_lot_remove_split (GNCLot *lot, Split *split)
     ENTER ("(lot=%p, split=%p)", lot, split);
     gnc_lot_begin_edit(lot);
     qof_instance_set_dirty(QOF_INSTANCE(lot));
+    if (g_list_find (priv->splits, split))
+        lot_balance_update (priv, split->amount, TRUE);
     priv->splits = g_list_remove (priv->splits, split);
     xaccSplitSetLot(split, NULL);
     priv->is_closed = LOT_CLOSED_UNKNOWN;   /* force an is-closed computation */
@@ -633,6 +677,8 @@ gnc_lot_remove_split (GNCLot *lot, Split *split)
         xaccAccountRemoveLot (priv->account, lot);
         priv->account = NULL;
     }
+    else if (priv->account)
+        xaccAccountLotChanged (priv->account, lot);
     gnc_lot_commit_edit(lot);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_MODIFY, NULL);
     LEAVE("removed from lot");
@@ -746,6 +746,94 @@ denom_lcd(gnc_numeric a, gnc_numeric b, int64_t denom, int how)
     return denom;
 }
 
+/* The fast paths below do the arithmetic in 64 bits when the result is
+ * certain to be the one the GncNumeric/GncRational code would produce:
+ * positive denominators that are multiples of one another (which covers
+ * amounts in the same SCU and power-of-ten commodities), a denomination
+ * type that neither reduces nor counts significant figures and a target
+ * denominator that needs no rounding. They return false, leaving the
+ * result untouched, when that isn't the case or 64 bits overflow; the
+ * caller then takes the slow path. INT64_MIN is refused because the
+ * slow path treats it as too big and rounds it.
+ */
+static inline bool
+fast_path_how(int how)
+{
+    auto dtype = how & GNC_NUMERIC_DENOM_MASK;
+    return dtype != GNC_HOW_DENOM_REDUCE && dtype != GNC_HOW_DENOM_SIGFIG;
+}
+
+static inline bool
+fast_add(gnc_numeric a, gnc_numeric b, int64_t denom, int how,
+         gnc_numeric& result)
+{
+    if (a.denom <= 0 || b.denom <= 0 || !fast_path_how(how))
+        return false;
+    int64_t anum{a.num}, bnum{b.num}, den{a.denom}, num;
+    if (a.denom != b.denom)
+    {
+        if (denom == GNC_DENOM_AUTO &&
+            (how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
+            return false; // GncNumeric's operator+ keeps a zero's partner.
+        if (b.denom % a.denom == 0)
+        {
+            den = b.denom;
+            if (__builtin_mul_overflow(anum, b.denom / a.denom, &anum))
+                return false;
+        }
+        else if (a.denom % b.denom == 0)
+        {
+            if (__builtin_mul_overflow(bnum, a.denom / b.denom, &bnum))
+                return false;
+        }
+        else
+            return false;
+    }
+    if (denom != GNC_DENOM_AUTO && denom != den)
+        return false;
+    if (__builtin_add_overflow(anum, bnum, &num) || num == INT64_MIN)
+        return false;
+    if (num == 0 && denom == GNC_DENOM_AUTO &&
+        (how & GNC_NUMERIC_DENOM_MASK) == GNC_HOW_DENOM_EXACT &&
+        (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
+        den = 1; // GncRational::round_to_numeric's zero.
+    result = {num, den};
+    return true;
+}
+
+static inline bool
+fast_mul(gnc_numeric a, gnc_numeric b, int64_t denom, int how,
+         gnc_numeric& result)
+{
+    if (a.denom <= 0 || b.denom <= 0 || !fast_path_how(how))
+        return false;
+    int64_t num, den;
+    if (__builtin_mul_overflow(a.num, b.num, &num) ||
+        __builtin_mul_overflow(a.denom, b.denom, &den))
+        return false;
+    bool exact = (how & GNC_NUMERIC_DENOM_MASK) == GNC_HOW_DENOM_EXACT;
+    if (num == 0)
+    {
+        if (denom != GNC_DENOM_AUTO)
+            den = denom;
+        else if (!exact || (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER)
+            den = 1;
+        result = {0, den};
+        return true;
+    }
+    if (denom != GNC_DENOM_AUTO && denom != den)
+    {
+        if (denom % den != 0 ||
+            __builtin_mul_overflow(num, denom / den, &num))
+            return false;
+        den = denom;
+    }
+    if (num == INT64_MIN)
+        return false;
+    result = {num, den};
+    return true;
+}
+
 /* *******************************************************************
  *  gnc_numeric_add
  ********************************************************************/
@@ -759,6 +847,9 @@ gnc_numeric_add(gnc_numeric a, gnc_numeric b,
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
     denom = denom_lcd(a, b, denom, how);
+    gnc_numeric result;
+    if (fast_add(a, b, denom, how, result))
+        return result;
     try
     {
         if ((how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
@@ -813,6 +904,13 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
     denom = denom_lcd(a, b, denom, how);
+    if (b.num != INT64_MIN)
+    {
+        gnc_numeric result;
+        nb = {-b.num, b.denom};
+        if (fast_add(a, nb, denom, how, result))
+            return result;
+    }
     try
     {
         if ((how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
@@ -853,6 +951,32 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
     }
 }
 
+/* *******************************************************************
+ *  gnc_numeric_sum
+ ********************************************************************/
+
+gnc_numeric
+gnc_numeric_sum(const gnc_numeric *values, guint n_values,
+                gint64 denom, gint how)
+{
+    gnc_numeric sum = gnc_numeric_zero();
+    g_return_val_if_fail (values || !n_values,
+                          gnc_numeric_error(GNC_ERROR_ARG));
+    for (guint i = 0; i < n_values; ++i)
+    {
+        auto value = values[i];
+        if (gnc_numeric_check(value))
+            return gnc_numeric_error(GNC_ERROR_ARG);
+        /* Amounts of one account share a denominator, so nearly every
+         * step stays in the 64-bit fast path and skips the call. */
+        if (!fast_add(sum, value, denom_lcd(sum, value, denom, how), how, sum))
+            sum = gnc_numeric_add(sum, value, denom, how);
+        if (gnc_numeric_check(sum))
+            return i + 1 < n_values ? gnc_numeric_error(GNC_ERROR_ARG) : sum;
+    }
+    return sum;
+}
+
 /* *******************************************************************
  *  gnc_numeric_mul
  ********************************************************************/
@@ -866,6 +990,9 @@ gnc_numeric_mul(gnc_numeric a, gnc_numeric b,
         return gnc_numeric_error(GNC_ERROR_ARG);
     }
     denom = denom_lcd(a, b, denom, how);
+    gnc_numeric result;
+    if (fast_mul(a, b, denom, how, result))
+        return result;
     try
     {
         if ((how & GNC_NUMERIC_DENOM_MASK) != GNC_HOW_DENOM_EXACT)
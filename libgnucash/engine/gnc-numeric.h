@@ -396,6 +396,13 @@ gnc_numeric gnc_numeric_add(gnc_numeric a, gnc_numeric b,
 gnc_numeric gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
                             gint64 denom, gint how);
 
+/** Return the sum of n_values values, the same as adding them in order
+ *  to zero with gnc_numeric_add(sum, values[i], denom, how) but without
+ *  a function call per value while they share a denominator.
+ */
+gnc_numeric gnc_numeric_sum(const gnc_numeric *values, guint n_values,
+                            gint64 denom, gint how);
+
 /** Multiply a times b, returning the product.  An overflow
  *  may occur if the result of the multiplication can't
  *  be represented as a ratio of 64-bit int's after removing
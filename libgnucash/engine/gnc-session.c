@@ -61,6 +61,7 @@ void gnc_clear_current_session()
 {
     if (current_session)
     {
+        xaccLogFlush();
         xaccLogDisable();
         qof_session_destroy(current_session);
         xaccLogEnable();
@@ -1228,6 +1228,7 @@ gncInvoiceDetachFromLot (GNCLot *lot)
     gnc_lot_begin_edit (lot);
     qof_instance_set (QOF_INSTANCE (lot), "invoice", NULL, NULL);
     gnc_lot_commit_edit (lot);
+    gncOwnerLotIndexLotChanged (lot);
 }
 
 void
@@ -1242,6 +1243,7 @@ gncInvoiceAttachToLot (GncInvoice *invoice, GNCLot *lot)
     gnc_lot_begin_edit (lot);
     qof_instance_set (QOF_INSTANCE (lot), "invoice", guid, NULL);
     gnc_lot_commit_edit (lot);
+    gncOwnerLotIndexLotChanged (lot);
     gncInvoiceSetPostedLot (invoice, lot);
 }
 
@@ -1919,8 +1921,8 @@ void gncInvoiceAutoApplyPayments (GncInvoice *invoice)
      * could be used. */
     lm.positive_balance =  gnc_numeric_positive_p (gnc_lot_get_balance (inv_lot));
     lm.owner = owner;
-    lot_list = xaccAccountFindOpenLots (acct, gnc_lot_match_owner_balancing,
-                                        &lm, NULL);
+    lot_list = gncOwnerFindOpenLots (owner, acct, gnc_lot_match_owner_balancing,
+                                     &lm, (GCompareFunc)gncOwnerLotsSortFunc);
 
     lot_list = g_list_prepend (lot_list, inv_lot);
     gncOwnerAutoApplyPaymentsWithLots (owner, lot_list);
@@ -52,6 +52,7 @@
 #define _GNC_MOD_NAME   GNC_ID_OWNER
 
 #define GNC_OWNER_ID    "gncOwner"
+#define GNC_OWNER_LOT_INDEX "gnc-owner-lot-index"
 
 static QofLogModule log_module = GNC_MOD_ENGINE;
 
@@ -632,6 +633,7 @@ void gncOwnerAttachToLot (const GncOwner *owner, GNCLot *lot)
 		      GNC_OWNER_GUID, gncOwnerGetGUID (owner),
 		      NULL);
     gnc_lot_commit_edit (lot);
+    gncOwnerLotIndexLotChanged (lot);
 }
 
 gboolean gncOwnerGetOwnerFromLot (GNCLot *lot, GncOwner *owner)
@@ -725,11 +727,20 @@ gncOwnerLotMatchOwnerFunc (GNCLot *lot, gpointer user_data)
     return gncOwnerEqual (end_owner, req_owner);
 }
 
+static time64
+owner_lot_posted_date (GNCLot *lot, GncInvoice *invoice)
+{
+    if (invoice)
+        return gncInvoiceGetDatePosted (invoice);
+    return xaccTransRetDatePosted (xaccSplitGetParent (gnc_lot_get_earliest_split (lot)));
+}
+
 gint
 gncOwnerLotsSortFunc (GNCLot *lotA, GNCLot *lotB)
 {
     GncInvoice *ia, *ib;
     time64 da, db;
+    gint cmp;
 
     ia = gncInvoiceGetInvoiceFromLot (lotA);
     ib = gncInvoiceGetInvoiceFromLot (lotB);
@@ -744,7 +755,23 @@ gncOwnerLotsSortFunc (GNCLot *lotA, GNCLot *lotB)
     else
         db = xaccTransRetDatePosted (xaccSplitGetParent (gnc_lot_get_earliest_split (lotB)));
 
-    return (da > db) - (da < db);
+    if (da != db)
+        return (da > db) - (da < db);
+
+    /* Break ties so that payments are applied in the same order every
+     * time: by posted date, then invoice ID, then GUID. */
+    da = owner_lot_posted_date (lotA, ia);
+    db = owner_lot_posted_date (lotB, ib);
+    if (da != db)
+        return (da > db) - (da < db);
+
+    cmp = g_strcmp0 (ia ? gncInvoiceGetID (ia) : NULL,
+                     ib ? gncInvoiceGetID (ib) : NULL);
+    if (cmp)
+        return cmp;
+
+    return guid_compare (qof_instance_get_guid (QOF_INSTANCE (lotA)),
+                         qof_instance_get_guid (QOF_INSTANCE (lotB)));
 }
 
 GNCLot *
@@ -1426,8 +1453,8 @@ gncOwnerApplyPaymentSecs (const GncOwner *owner, Transaction **preset_txn,
     if (lots)
         selected_lots = lots;
     else if (auto_pay)
-        selected_lots = xaccAccountFindOpenLots (posted_acc, gncOwnerLotMatchOwnerFunc,
-                        (gpointer)owner, NULL);
+        selected_lots = gncOwnerFindOpenLots (owner, posted_acc, NULL, NULL,
+                                              (GCompareFunc)gncOwnerLotsSortFunc);
 
     /* And link the selected lots and the payment lot together as well as possible.
      * If the payment was bigger than the selected documents/overpayments, only
@@ -1469,6 +1496,263 @@ gncOwnerGetCommoditiesList (const GncOwner *owner)
 /*********************************************************************/
 /* Owner balance calculation routines                                */
 
+/* Owner lot index
+ *
+ * Each book keeps an index from the GUID of an end owner to the set of
+ * open lots belonging to it, so that owner balances need not read the
+ * owner KVP of every lot in every AR/AP account.  It is built
+ * on first use.  Lot events and the functions attaching owners and
+ * invoices to lots only mark a lot stale; stale lots are re-indexed
+ * the next time the index is used.  If events were suspended in the
+ * meantime the index is rebuilt, since lots may have been destroyed
+ * without notice.
+ */
+typedef struct
+{
+    GHashTable *lots_by_owner;  /* GncGUID* -> set of GNCLot* */
+    GHashTable *lot_owners;     /* GNCLot* -> its key in lots_by_owner */
+    GHashTable *stale_lots;     /* set of GNCLot* */
+    gboolean rebuild;
+    guint dropped_events;
+} OwnerLotIndex;
+
+static gint owner_lot_index_handler_id = 0;
+
+static const GncOwner *
+owner_lot_get_end_owner (GNCLot *lot, GncOwner *lot_owner)
+{
+    GncInvoice *invoice = gncInvoiceGetInvoiceFromLot (lot);
+
+    if (invoice)
+        return gncOwnerGetEndOwner (gncInvoiceGetOwner (invoice));
+    if (gncOwnerGetOwnerFromLot (lot, lot_owner))
+        return gncOwnerGetEndOwner (lot_owner);
+    return NULL;
+}
+
+static void
+owner_lot_index_remove (OwnerLotIndex *index, GNCLot *lot)
+{
+    GncGUID *key = g_hash_table_lookup (index->lot_owners, lot);
+    if (key)
+    {
+        GHashTable *lots = g_hash_table_lookup (index->lots_by_owner, key);
+        g_hash_table_remove (index->lot_owners, lot);
+        g_hash_table_remove (lots, lot);
+        if (g_hash_table_size (lots) == 0)
+            g_hash_table_remove (index->lots_by_owner, key);
+    }
+}
+
+static void
+owner_lot_index_add (OwnerLotIndex *index, GNCLot *lot)
+{
+    GncOwner lot_owner;
+    const GncOwner *end_owner;
+    const GncGUID *guid;
+    GHashTable *lots;
+    gpointer key;
+
+    if (!gnc_lot_get_account (lot) || gnc_lot_is_closed (lot))
+        return;
+    end_owner = owner_lot_get_end_owner (lot, &lot_owner);
+    guid = end_owner ? gncOwnerGetGUID (end_owner) : NULL;
+    if (!guid || guid_equal (guid, guid_null ()))
+        return;
+
+    if (!g_hash_table_lookup_extended (index->lots_by_owner, guid, &key,
+                                       (gpointer*)&lots))
+    {
+        key = guid_copy (guid);
+        lots = g_hash_table_new (NULL, NULL);
+        g_hash_table_insert (index->lots_by_owner, key, lots);
+    }
+    g_hash_table_add (lots, lot);
+    g_hash_table_insert (index->lot_owners, lot, key);
+}
+
+static void
+owner_lot_index_add_lot (QofInstance *lot, gpointer data)
+{
+    owner_lot_index_add (data, GNC_LOT (lot));
+}
+
+static void
+owner_lot_index_free (QofBook *book, gpointer key, gpointer data)
+{
+    OwnerLotIndex *index = data;
+
+    g_hash_table_destroy (index->lots_by_owner);
+    g_hash_table_destroy (index->lot_owners);
+    g_hash_table_destroy (index->stale_lots);
+    g_free (index);
+}
+
+static void
+owner_lot_index_event_handler (QofInstance *entity, QofEventId event_type,
+                               gpointer user_data, gpointer event_data)
+{
+    OwnerLotIndex *index;
+    QofBook *book;
+
+    if (!GNC_IS_LOT (entity) && !GNC_IS_JOB (entity))
+        return;
+    /* The index is freed before the lots of a book being destroyed. */
+    book = qof_instance_get_book (entity);
+    if (!book || qof_book_shutting_down (book))
+        return;
+    index = qof_book_get_data (book, GNC_OWNER_LOT_INDEX);
+    if (!index)
+        return;
+
+    if (GNC_IS_JOB (entity))
+    {
+        /* The job may have moved to another owner, and its lots with it. */
+        if (event_type & QOF_EVENT_MODIFY)
+            index->rebuild = TRUE;
+    }
+    else if (event_type & QOF_EVENT_DESTROY)
+    {
+        owner_lot_index_remove (index, GNC_LOT (entity));
+        g_hash_table_remove (index->stale_lots, entity);
+    }
+    else
+        g_hash_table_add (index->stale_lots, entity);
+}
+
+static OwnerLotIndex *
+owner_lot_index_get (QofBook *book)
+{
+    OwnerLotIndex *index = qof_book_get_data (book, GNC_OWNER_LOT_INDEX);
+    guint dropped = qof_event_get_dropped_count ();
+
+    if (!owner_lot_index_handler_id)
+        owner_lot_index_handler_id =
+            qof_event_register_handler (owner_lot_index_event_handler, NULL);
+
+    if (!index)
+    {
+        index = g_new0 (OwnerLotIndex, 1);
+        index->lots_by_owner = g_hash_table_new_full (guid_hash_to_guint,
+                                                      guid_g_hash_table_equal,
+                                                      (GDestroyNotify)guid_free,
+                                                      (GDestroyNotify)g_hash_table_destroy);
+        index->lot_owners = g_hash_table_new (NULL, NULL);
+        index->stale_lots = g_hash_table_new (NULL, NULL);
+        index->rebuild = TRUE;
+        qof_book_set_data_fin (book, GNC_OWNER_LOT_INDEX, index,
+                               owner_lot_index_free);
+    }
+
+    if (index->rebuild || index->dropped_events != dropped)
+    {
+        g_hash_table_remove_all (index->lots_by_owner);
+        g_hash_table_remove_all (index->lot_owners);
+        g_hash_table_remove_all (index->stale_lots);
+        qof_collection_foreach (qof_book_get_collection (book, GNC_ID_LOT),
+                                owner_lot_index_add_lot, index);
+        index->rebuild = FALSE;
+        index->dropped_events = dropped;
+    }
+    else if (g_hash_table_size (index->stale_lots))
+    {
+        GHashTableIter iter;
+        gpointer lot;
+
+        g_hash_table_iter_init (&iter, index->stale_lots);
+        while (g_hash_table_iter_next (&iter, &lot, NULL))
+        {
+            owner_lot_index_remove (index, lot);
+            owner_lot_index_add (index, lot);
+        }
+        g_hash_table_remove_all (index->stale_lots);
+    }
+    return index;
+}
+
+/* Called when an owner or invoice is attached to or detached from a
+ * lot, which changes the lot's owner without an event. */
+void
+gncOwnerLotIndexLotChanged (GNCLot *lot)
+{
+    OwnerLotIndex *index;
+    QofBook *book;
+
+    if (!lot)
+        return;
+    book = gnc_lot_get_book (lot);
+    if (!book || qof_book_shutting_down (book))
+        return;
+    index = qof_book_get_data (book, GNC_OWNER_LOT_INDEX);
+    if (index)
+        g_hash_table_add (index->stale_lots, lot);
+}
+
+GList *
+gncOwnerGetOpenLots (const GncOwner *owner)
+{
+    OwnerLotIndex *index;
+    GHashTable *lots;
+    const GncGUID *guid;
+
+    g_return_val_if_fail (owner, NULL);
+
+    guid = gncOwnerGetGUID (owner);
+    if (!guid)
+        return NULL;
+    index = owner_lot_index_get (qof_instance_get_book (qofOwnerGetOwner (owner)));
+    lots = g_hash_table_lookup (index->lots_by_owner, guid);
+    return lots ? g_hash_table_get_keys (lots) : NULL;
+}
+
+static gint
+owner_lot_guid_compare (gconstpointer a, gconstpointer b)
+{
+    return guid_compare (qof_instance_get_guid (QOF_INSTANCE (a)),
+                         qof_instance_get_guid (QOF_INSTANCE (b)));
+}
+
+GList *
+gncOwnerFindOpenLots (const GncOwner *owner, const Account *account,
+                      gboolean (*match_func)(GNCLot *lot, gpointer user_data),
+                      gpointer user_data, GCompareFunc sort_func)
+{
+    GList *lots, *node, *next;
+
+    g_return_val_if_fail (account, NULL);
+
+    /* The index doesn't keep the lots in any order, so put them in
+     * GUID order first to make the result the same every time, whether
+     * sort_func leaves ties or there's none. */
+    lots = g_list_sort (gncOwnerGetOpenLots (owner), owner_lot_guid_compare);
+    for (node = lots; node; node = next)
+    {
+        GNCLot *lot = node->data;
+
+        next = node->next;
+        if (gnc_lot_get_account (lot) != account || gnc_lot_is_closed (lot) ||
+            (match_func && !match_func (lot, user_data)))
+            lots = g_list_delete_link (lots, node);
+    }
+
+    if (sort_func)
+        lots = g_list_sort (lots, sort_func);
+    return lots;
+}
+
+/* Whether lot is in one of the owner's AR/AP account types and in the
+ * owner's currency, as the balance only counts those. */
+static gboolean
+owner_lot_counts (GNCLot *lot, GList *acct_types,
+                  const gnc_commodity *owner_currency)
+{
+    Account *account = gnc_lot_get_account (lot);
+
+    return account &&
+        g_list_index (acct_types, (gpointer)xaccAccountGetType (account)) != -1 &&
+        gnc_commodity_equal (owner_currency, xaccAccountGetCommodity (account));
+}
+
 /*
  * Given an owner, extract the open balance from the owner and then
  * convert it to the desired currency.
@@ -1494,41 +1778,23 @@ gncOwnerGetBalanceInCurrency (const GncOwner *owner,
     else
     {
         /* No valid cache value found for balance. Let's recalculate */
-        GList *acct_list  = gnc_account_get_descendants (gnc_book_get_root_account (book));
+        GList *lot_list = gncOwnerGetOpenLots (owner);
         GList *acct_types = gncOwnerGetAccountTypesList (owner);
-        GList *acct_node;
+        GList *lot_node;
 
-        /* For each account */
-        for (acct_node = acct_list; acct_node; acct_node = acct_node->next)
+        /* For each lot */
+        for (lot_node = lot_list; lot_node; lot_node = lot_node->next)
         {
-            Account *account = acct_node->data;
-            GList *lot_list = NULL, *lot_node;
+            GNCLot *lot = lot_node->data;
 
-            /* Check if this account can have lots for the owner, otherwise skip to next */
-            if (g_list_index (acct_types, (gpointer)xaccAccountGetType (account))
-                    == -1)
+            if (!owner_lot_counts (lot, acct_types, owner_currency))
                 continue;
-
-
-            if (!gnc_commodity_equal (owner_currency, xaccAccountGetCommodity (account)))
-                continue;
-
-            /* Get a list of open lots for this owner and account */
-            lot_list = xaccAccountFindOpenLots (account, gncOwnerLotMatchOwnerFunc,
-                                                (gpointer)owner, NULL);
-            /* For each lot */
-            for (lot_node = lot_list; lot_node; lot_node = lot_node->next)
-            {
-                GNCLot *lot = lot_node->data;
-                gnc_numeric lot_balance = gnc_lot_get_balance (lot);
-                GncInvoice *invoice = gncInvoiceGetInvoiceFromLot(lot);
-                if (invoice)
-                balance = gnc_numeric_add (balance, lot_balance,
-                                            gnc_commodity_get_fraction (owner_currency), GNC_HOW_RND_ROUND_HALF_UP);
-            }
-            g_list_free (lot_list);
+            if (gncInvoiceGetInvoiceFromLot (lot))
+                balance = gnc_numeric_add (balance, gnc_lot_get_balance (lot),
+                                           gnc_commodity_get_fraction (owner_currency),
+                                           GNC_HOW_RND_ROUND_HALF_UP);
         }
-        g_list_free (acct_list);
+        g_list_free (lot_list);
         g_list_free (acct_types);
 
         gncOwnerSetCachedBalance (owner, &balance);
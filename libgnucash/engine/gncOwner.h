@@ -187,8 +187,9 @@ void gncOwnerAttachToLot (const GncOwner *owner, GNCLot *lot);
 gboolean gncOwnerLotMatchOwnerFunc (GNCLot *lot, gpointer user_data);
 
 /** Helper function used to sort lots by date. If the lot is
- * linked to an invoice, use the invoice posted date, otherwise
- * use the lot's opened date.
+ * linked to an invoice, use the invoice due date, otherwise
+ * use the lot's opened date. Lots with the same date are ordered
+ * by posted date, then invoice ID, then GUID.
  */
 gint gncOwnerLotsSortFunc (GNCLot *lotA, GNCLot *lotB);
 
@@ -316,6 +317,24 @@ gnc_numeric
 gncOwnerGetBalanceInCurrency (const GncOwner *owner,
                               const gnc_commodity *report_currency);
 
+/** Returns a GList of the open lots of an owner, found through an index
+ *  kept per book rather than by scanning all lots.  The lots of a job
+ *  are listed under the job's owner, not the job.  The list must be
+ *  freed by the caller, the lots not.
+ */
+GList * gncOwnerGetOpenLots (const GncOwner *owner);
+
+/** Like xaccAccountFindOpenLots, but only considers the open lots of
+ *  owner in account, as found by gncOwnerGetOpenLots.  Use this rather
+ *  than matching with gncOwnerLotMatchOwnerFunc, which has to look at
+ *  every lot in the account.  Without sort_func the lots are in GUID
+ *  order.
+ */
+GList * gncOwnerFindOpenLots (const GncOwner *owner, const Account *account,
+                              gboolean (*match_func)(GNCLot *lot,
+                                                     gpointer user_data),
+                              gpointer user_data, GCompareFunc sort_func);
+
 #define OWNER_TYPE        "type"
 #define OWNER_TYPE_STRING "type-string"  /**< Allows the type to be handled externally. */
 #define OWNER_CUSTOMER    "customer"
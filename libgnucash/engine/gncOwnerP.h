@@ -33,6 +33,8 @@
 gboolean gncOwnerRegister (void);
 const gnc_numeric *gncOwnerGetCachedBalance (const GncOwner *owner);
 void gncOwnerSetCachedBalance (const GncOwner *owner, const gnc_numeric *new_bal);
+/** Tell the owner lot index that the owner or invoice of lot changed. */
+void gncOwnerLotIndexLotChanged (GNCLot *lot);
 
 
 #endif /* GNC_OWNERP_H_ */
@@ -139,6 +139,11 @@ void qof_event_suspend (void);
 /** Resume engine event generation. */
 void qof_event_resume (void);
 
+/** Return the number of events dropped so far because events were
+ *  suspended.  A cache kept up to date from event handlers can compare
+ *  it with the value it was built at to tell whether it missed any. */
+guint qof_event_get_dropped_count (void);
+
 #ifdef __cplusplus
 }
 #endif
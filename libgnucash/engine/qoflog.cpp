@@ -67,6 +67,20 @@ static GHashTable *log_table = NULL;
 static GLogFunc previous_handler = NULL;
 static gchar* qof_logger_format = NULL;
 
+gint qof_log_generation = 0;
+
+/* The latest QofLogCacheEntry of each log module, shared by its call
+ * sites.  Entries are never freed: call sites in other threads may still
+ * be reading one after it has been replaced. */
+static GHashTable *log_cache_entries = NULL;
+static GMutex log_cache_mutex;
+
+static void
+qof_log_levels_changed (void)
+{
+    g_atomic_int_inc (&qof_log_generation);
+}
+
 void
 qof_log_indent(void)
 {
@@ -223,6 +237,7 @@ qof_log_shutdown (void)
     {
         g_hash_table_destroy(log_table);
         log_table = NULL;
+        qof_log_levels_changed();
     }
 
     if (previous_handler != NULL)
@@ -244,6 +259,7 @@ qof_log_set_level(QofLogModule log_module, QofLogLevel level)
         log_table = g_hash_table_new(g_str_hash, g_str_equal);
     }
     g_hash_table_insert(log_table, g_strdup((gchar*)log_module), GINT_TO_POINTER((gint)level));
+    qof_log_levels_changed();
 }
 
 const char *
@@ -350,6 +366,7 @@ qof_log_parse_log_config(const char *filename)
 
         g_free (str);
         g_strfreev(levels);
+        qof_log_levels_changed();
     }
 
     if (g_key_file_has_group(conf, output_group))
@@ -381,52 +398,84 @@ qof_log_parse_log_config(const char *filename)
     g_key_file_free(conf);
 }
 
-gboolean
-qof_log_check(QofLogModule log_domain, QofLogLevel log_level)
+#define QOF_LOG_DOMAIN_BUF_SIZE 128
+
+static QofLogLevel
+qof_log_threshold(QofLogModule log_domain)
 {
-//#define _QLC_DBG(x) x
-#define _QLC_DBG(x)
     GHashTable *log_levels = log_table;
-    gchar *domain_copy = g_strdup(log_domain == NULL ? "" : log_domain);
-    gchar *dot_pointer = domain_copy;
     static const QofLogLevel default_log_thresh = QOF_LOG_WARNING;
     QofLogLevel longest_match_level = default_log_thresh;
+    gchar domain_buf[QOF_LOG_DOMAIN_BUF_SIZE];
+    gchar *domain_copy, *dot_pointer;
+    gpointer match_level;
+    size_t len;
+
+    if (G_LIKELY(!log_levels))
+        return longest_match_level;
+
+    if ((match_level = g_hash_table_lookup(log_levels, "")) != NULL)
+        longest_match_level = (QofLogLevel)GPOINTER_TO_INT(match_level);
+
+    if (log_domain == NULL)
+        log_domain = "";
+    len = strlen(log_domain);
+    /* Log domains are short; only copy to the heap for absurd ones. */
+    if (len < sizeof(domain_buf))
+        domain_copy = static_cast<gchar*>(memcpy(domain_buf, log_domain, len + 1));
+    else
+        domain_copy = g_strdup(log_domain);
 
+    // e.g., "a.b.c\0" -> "a\0b.c\0" -> "a.b\0c\0", "a.b.c\0"
+    dot_pointer = domain_copy;
+    while ((dot_pointer = strchr(dot_pointer, '.')) != NULL)
     {
-        gpointer match_level;
-        if (log_levels && (match_level = g_hash_table_lookup(log_levels, "")) != NULL)
+        *dot_pointer = '\0';
+        if (g_hash_table_lookup_extended(log_levels, domain_copy, NULL, &match_level))
             longest_match_level = (QofLogLevel)GPOINTER_TO_INT(match_level);
+        *dot_pointer = '.';
+        dot_pointer++;
     }
 
-_QLC_DBG( { printf("trying [%s] (%d):", log_domain, log_levels != NULL ? g_hash_table_size(log_levels) : 0); });
-    if (G_LIKELY(log_levels))
-    {
-        // e.g., "a.b.c\0" -> "a\0b.c\0" -> "a.b\0c\0", "a.b.c\0"
-        gpointer match_level;
-        while ((dot_pointer = g_strstr_len(dot_pointer, strlen(dot_pointer), ".")) != NULL)
-        {
-            *dot_pointer = '\0';
-            _QLC_DBG( { printf(" [%s]", domain_copy); });
-            if (g_hash_table_lookup_extended(log_levels, domain_copy, NULL, &match_level))
-            {
-                longest_match_level = (QofLogLevel)GPOINTER_TO_INT(match_level);
-                _QLC_DBG(printf("*"););
-            }
-            *dot_pointer = '.';
-            dot_pointer++;
-        }
+    if (g_hash_table_lookup_extended(log_levels, domain_copy, NULL, &match_level))
+        longest_match_level = (QofLogLevel)GPOINTER_TO_INT(match_level);
 
-        _QLC_DBG( { printf(" [%s]", domain_copy); });
-        if (g_hash_table_lookup_extended(log_levels, domain_copy, NULL, &match_level))
-        {
-            longest_match_level = (QofLogLevel)GPOINTER_TO_INT(match_level);
-            _QLC_DBG( { printf("*"); });
-        }
+    if (domain_copy != domain_buf)
+        g_free(domain_copy);
+    return longest_match_level;
+}
+
+gboolean
+qof_log_check(QofLogModule log_domain, QofLogLevel log_level)
+{
+    return log_level <= qof_log_threshold(log_domain);
+}
+
+const QofLogCacheEntry *
+qof_log_cache_refresh(QofLogCache *cache, QofLogModule log_module)
+{
+    /* Read the generation first: if the levels change while the
+     * threshold is looked up, the entry is simply stale at once. */
+    gint generation = g_atomic_int_get (&qof_log_generation);
+    QofLogCacheEntry *entry;
+
+    g_mutex_lock (&log_cache_mutex);
+    if (!log_cache_entries)
+        log_cache_entries = g_hash_table_new (g_direct_hash, g_direct_equal);
+    entry = static_cast<QofLogCacheEntry*>(g_hash_table_lookup (log_cache_entries,
+                                                                log_module));
+    if (!entry || entry->generation != generation)
+    {
+        entry = g_new (QofLogCacheEntry, 1);
+        entry->module = log_module;
+        entry->generation = generation;
+        entry->threshold = qof_log_threshold(log_module);
+        g_hash_table_insert (log_cache_entries, (gpointer)log_module, entry);
     }
-    _QLC_DBG( { printf(" found [%d]\n", longest_match_level); });
-    g_free(domain_copy);
+    g_mutex_unlock (&log_cache_mutex);
 
-    return log_level <= longest_match_level;
+    g_atomic_pointer_set (&cache->entry, entry);
+    return entry;
 }
 
 void
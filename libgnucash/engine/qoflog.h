@@ -171,6 +171,50 @@ gboolean qof_log_check(QofLogModule log_module, QofLogLevel log_level);
 /** Set the default level for QOF-related log paths. **/
 void qof_log_set_default(QofLogLevel log_level);
 
+/** The threshold of one log module for one generation of the log
+ * levels.  Never changed or freed once created. **/
+typedef struct
+{
+    QofLogModule module;
+    gint generation;
+    QofLogLevel threshold;
+} QofLogCacheEntry;
+
+/** The threshold of one log module, remembered at a call site.  A
+ * zero-initialized cache is valid and resolves on first use.  A call
+ * site may run in several threads at once, so the cache is a single
+ * pointer to a QofLogCacheEntry, read and replaced atomically. **/
+typedef struct
+{
+    gpointer entry;
+} QofLogCache;
+
+/** Incremented whenever a log level changes, which invalidates every
+ * QofLogCache.  Use qof_log_check_cached() rather than reading it
+ * directly. **/
+extern gint qof_log_generation;
+
+/** Look up the threshold of @a log_module, store it in @a cache and
+ * return it. **/
+const QofLogCacheEntry *qof_log_cache_refresh(QofLogCache *cache,
+                                              QofLogModule log_module);
+
+/** Same as qof_log_check(), but when the levels haven't changed since
+ * @a cache was last filled for @a log_module it costs only a couple of
+ * comparisons. **/
+static inline gboolean
+qof_log_check_cached(QofLogCache *cache, QofLogModule log_module,
+                     QofLogLevel log_level)
+{
+    const QofLogCacheEntry *entry =
+        (const QofLogCacheEntry*)g_atomic_pointer_get(&cache->entry);
+    if (G_UNLIKELY(!entry ||
+                   entry->generation != g_atomic_int_get(&qof_log_generation) ||
+                   entry->module != log_module))
+        entry = qof_log_cache_refresh(cache, log_module);
+    return log_level <= entry->threshold;
+}
+
 #define PRETTY_FUNC_NAME qof_log_prettify(G_STRFUNC)
 
 #ifdef _MSC_VER
@@ -214,7 +258,9 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print a function entry debugging message */
 #define ENTER(format, ...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    static QofLogCache qof_log_cache_; \
+    if (qof_log_check_cached(&qof_log_cache_, log_module, \
+                             (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[enter %s:%s()] " format, __FILE__, \
         PRETTY_FUNC_NAME , __VA_ARGS__); \
@@ -224,7 +270,9 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print a function exit debugging message. **/
 #define LEAVE(format, ...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    static QofLogCache qof_log_cache_; \
+    if (qof_log_check_cached(&qof_log_cache_, log_module, \
+                             (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
       qof_log_dedent(); \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[leave %s()] " format, \
@@ -266,7 +314,9 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print a function entry debugging message */
 #define ENTER(format, args...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    static QofLogCache qof_log_cache_; \
+    if (qof_log_check_cached(&qof_log_cache_, log_module, \
+                             (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[enter %s:%s()] " format, __FILE__, \
         PRETTY_FUNC_NAME , ## args); \
@@ -276,7 +326,9 @@ void qof_log_set_default(QofLogLevel log_level);
 
 /** Print a function exit debugging message. **/
 #define LEAVE(format, args...) do { \
-    if (qof_log_check(log_module, (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
+    static QofLogCache qof_log_cache_; \
+    if (qof_log_check_cached(&qof_log_cache_, log_module, \
+                             (QofLogLevel)G_LOG_LEVEL_DEBUG)) { \
       qof_log_dedent(); \
       g_log (log_module, G_LOG_LEVEL_DEBUG, \
         "[leave %s()] " format, \
@@ -0,0 +1,445 @@
+/********************************************************************\
+ * bench-engine.cpp -- Benchmark of engine and backend hot paths on *
+ *                     synthetic books                              *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/* Builds a book of about the requested number of splits for each scale
+ * with the test-engine-stuff generators, then times split insertion,
+ * balance computation, price lookups, queries, saving and loading with
+ * the XML and SQLite backends and the tree-wide scrubs on it. The same
+ * seed makes the same books. Not run by "make check"; build the
+ * bench-engine target and run it by hand from the build directory so
+ * that the backends are found:
+ *
+ *     GNC_UNINSTALLED=1 GNC_BUILDDIR=$PWD bin/bench-engine \
+ *         [-s seed] [-d dir] [splits...]
+ *
+ * The default scales are 10000 and 100000 splits. Files are written to
+ * dir, by default a temporary directory that is removed afterwards.
+ * Only the bench.gnucash* files written there are deleted.
+ * Each result is printed to stdout as a line of JSON, e.g.
+ *
+ *     {"benchmark": "xml-save", "scale": 10000, "ops": 1, "seconds": 0.5}
+ *
+ * where ops is the number of operations timed. The SQLite benchmarks
+ * are skipped with a message on stderr if the DBI backend isn't built.
+ */
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "Account.h"
+#include "Query.h"
+#include "Scrub.h"
+#include "Scrub3.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-commodity.h"
+#include "gnc-engine.h"
+#include "gnc-pricedb.h"
+#include "qof.h"
+#include "test-engine-stuff.h"
+}
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using AccountVec = std::vector<Account*>;
+using CommodityPair = std::pair<gnc_commodity*, gnc_commodity*>;
+
+/* The balance dates, spread over the range of get_random_time. */
+static const guint n_dates = 12;
+/* The name of the book saved in dir. */
+static const char bench_file[] = "bench.gnucash";
+
+static void
+run (const char* name, guint64 scale, const std::function<guint64()>& func)
+{
+    auto start = std::chrono::steady_clock::now ();
+    auto ops = func ();
+    auto elapsed = std::chrono::steady_clock::now () - start;
+    std::cout << "{\"benchmark\": \"" << name << "\", \"scale\": " << scale
+              << ", \"ops\": " << ops << ", \"seconds\": "
+              << std::chrono::duration<double>(elapsed).count () << "}"
+              << std::endl;
+}
+
+static Account*
+random_account (const AccountVec& accounts)
+{
+    return accounts[rand () % accounts.size ()];
+}
+
+static void
+add_prices (QofBook* book, const AccountVec& accounts, guint64 n_prices)
+{
+    auto pdb = gnc_pricedb_get_db (book);
+    while (n_prices-- > 0)
+    {
+        auto commodity = xaccAccountGetCommodity (random_account (accounts));
+        auto currency = xaccAccountGetCommodity (random_account (accounts));
+        if (gnc_commodity_equal (commodity, currency))
+            continue;
+        auto price = gnc_price_create (book);
+        gnc_price_begin_edit (price);
+        gnc_price_set_commodity (price, commodity);
+        gnc_price_set_currency (price, currency);
+        gnc_price_set_time64 (price, get_random_time ());
+        gnc_price_set_source (price, PRICE_SOURCE_USER_PRICE);
+        gnc_price_set_typestr (price, PRICE_TYPE_LAST);
+        gnc_price_set_value (price,
+                             gnc_numeric_create (rand () % 100000 + 1, 100));
+        gnc_price_commit_edit (price);
+        gnc_pricedb_add_price (pdb, price);
+        gnc_price_unref (price);
+    }
+}
+
+/* Deep trees of about one account per 500 splits, each account with its
+ * own commodity, one price per 20 splits between account commodities
+ * and random transactions, cruddy ones included, up to n_splits. */
+static guint64
+make_book (QofBook* book, guint64 n_splits, AccountVec& accounts)
+{
+    set_max_account_tree_depth (6);
+    set_max_total_accounts (CLAMP (n_splits / 500, 10, 20000));
+    set_max_kvp_depth (1);
+    set_max_kvp_frame_elements (2);
+
+    auto root = get_random_account_tree (book);
+    auto descendants = gnc_account_get_descendants (root);
+    for (auto node = descendants; node; node = node->next)
+        accounts.push_back (static_cast<Account*>(node->data));
+
+    add_prices (book, accounts, n_splits / 20);
+
+    guint64 splits = 0;
+    while (splits < n_splits)
+    {
+        auto currency = xaccAccountGetCommodity (random_account (accounts));
+        auto trans = get_random_transaction_with_currency (book, currency,
+                                                           descendants);
+        if (!trans)
+            break;
+        splits += xaccTransCountSplits (trans);
+    }
+    g_list_free (descendants);
+    return splits;
+}
+
+static guint64
+insert_splits (QofBook* book, const AccountVec& accounts, guint64 n_trans)
+{
+    for (guint64 i = 0; i < n_trans; ++i)
+    {
+        Account* accts[] = {random_account (accounts),
+                            random_account (accounts)};
+        auto value = gnc_numeric_create (rand () % 100000 + 1, 100);
+        auto trans = xaccMallocTransaction (book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, xaccAccountGetCommodity (accts[0]));
+        xaccTransSetDatePostedSecsNormalized (trans, get_random_time ());
+        xaccTransSetDescription (trans, "Benchmark");
+        for (auto acc : accts)
+        {
+            auto split = xaccMallocSplit (book);
+            xaccSplitSetParent (split, trans);
+            xaccSplitSetAccount (split, acc);
+            xaccSplitSetValue (split, value);
+            xaccSplitSetAmount (split, value);
+            value = gnc_numeric_neg (value);
+        }
+        xaccTransCommitEdit (trans);
+    }
+    return 2 * n_trans;
+}
+
+static gboolean
+collect_price_pair (GNCPrice* price, gpointer data)
+{
+    auto pairs = static_cast<std::vector<CommodityPair>*>(data);
+    pairs->emplace_back (gnc_price_get_commodity (price),
+                         gnc_price_get_currency (price));
+    return TRUE;
+}
+
+static guint64
+lookup_prices (GNCPriceDB* pdb, const std::vector<CommodityPair>& pairs,
+               guint64 n_lookups, bool latest)
+{
+    if (pairs.empty ())
+        return 0;
+    for (guint64 i = 0; i < n_lookups; ++i)
+    {
+        auto& pair = pairs[rand () % pairs.size ()];
+        auto price = latest ?
+            gnc_pricedb_lookup_latest (pdb, pair.first, pair.second) :
+            gnc_pricedb_lookup_nearest_in_time64 (pdb, pair.first, pair.second,
+                                                  get_random_time ());
+        if (price)
+            gnc_price_unref (price);
+    }
+    return n_lookups;
+}
+
+static guint64
+run_query (QofBook* book, const std::function<void(QofQuery*)>& add_terms)
+{
+    auto query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    add_terms (query);
+    /* The results belong to the query. */
+    guint64 found = g_list_length (qof_query_run (query));
+    qof_query_destroy (query);
+    return found;
+}
+
+/* Removes the files a save and load left in dir: the book and the
+ * backends' .LCK, .LNK, log and backup files, whose names all start
+ * with the book's.  Anything else in dir is left alone. */
+static void
+remove_bench_files (const char* dir)
+{
+    auto gdir = g_dir_open (dir, 0, nullptr);
+    if (!gdir)
+        return;
+    while (auto name = g_dir_read_name (gdir))
+    {
+        if (!g_str_has_prefix (name, bench_file))
+            continue;
+        auto path = g_build_filename (dir, name, nullptr);
+        g_unlink (path);
+        g_free (path);
+    }
+    g_dir_close (gdir);
+}
+
+/* Saves the book of session through a new session on a file in dir,
+ * then loads the file into another one. */
+static void
+save_and_load (QofSession* session, const char* scheme, const char* dir,
+               guint64 scale)
+{
+    auto path = g_build_filename (dir, bench_file, nullptr);
+    auto uri = g_strconcat (scheme, "://", path, nullptr);
+    auto save_name = std::string (scheme) + "-save";
+    auto load_name = std::string (scheme) + "-load";
+    g_free (path);
+
+    auto save_session = qof_session_new ();
+    qof_session_begin (save_session, uri, FALSE, TRUE, TRUE);
+    auto err = qof_session_get_error (save_session);
+    if (err == ERR_BACKEND_NO_ERR)
+    {
+        qof_session_swap_data (session, save_session);
+        qof_book_mark_session_dirty (qof_session_get_book (save_session));
+        run (save_name.c_str (), scale, [save_session]() -> guint64 {
+            qof_session_save (save_session, nullptr);
+            return 1;
+        });
+        err = qof_session_get_error (save_session);
+        qof_session_swap_data (session, save_session);
+        qof_session_end (save_session);
+    }
+    qof_session_destroy (save_session);
+    if (err != ERR_BACKEND_NO_ERR)
+    {
+        std::cerr << "Skipping " << scheme << ": saving " << uri
+                  << " failed with error " << err << std::endl;
+        g_free (uri);
+        return;
+    }
+
+    auto load_session = qof_session_new ();
+    qof_session_begin (load_session, uri, TRUE, FALSE, FALSE);
+    run (load_name.c_str (), scale, [load_session]() -> guint64 {
+        qof_session_load (load_session, nullptr);
+        return 1;
+    });
+    err = qof_session_get_error (load_session);
+    if (err != ERR_BACKEND_NO_ERR)
+        std::cerr << "Loading " << uri << " failed with error " << err
+                  << std::endl;
+    qof_session_end (load_session);
+    qof_session_destroy (load_session);
+    g_free (uri);
+    remove_bench_files (dir);
+}
+
+static void
+bench_scale (guint64 scale, const char* dir)
+{
+    auto session = qof_session_new ();
+    auto book = qof_session_get_book (session);
+    auto pdb = gnc_pricedb_get_db (book);
+    AccountVec accounts;
+    guint64 splits = 0;
+
+    run ("generate", scale, [&]() -> guint64 {
+        return splits = make_book (book, scale, accounts);
+    });
+    if (accounts.size () < 2 || splits == 0)
+    {
+        std::cerr << "Generating a book of " << scale << " splits failed"
+                  << std::endl;
+        qof_session_destroy (session);
+        return;
+    }
+    auto root = gnc_book_get_root_account (book);
+
+    run ("insert-splits", scale, [&]() -> guint64 {
+        return insert_splits (book, accounts, MAX (scale / 20, 1));
+    });
+
+    run ("balance-recompute", scale, [&]() -> guint64 {
+        for (auto acc : accounts)
+        {
+            gnc_account_set_balance_dirty (acc);
+            xaccAccountRecomputeBalance (acc);
+        }
+        return accounts.size ();
+    });
+
+    time64 dates[n_dates];
+    for (guint i = 0; i < n_dates; ++i)
+        dates[i] = (i + 1) * static_cast<time64>(RAND_MAX / n_dates);
+
+    run ("balance-as-of-date", scale, [&]() -> guint64 {
+        for (auto acc : accounts)
+            for (auto date : dates)
+                xaccAccountGetBalanceAsOfDate (acc, date);
+        return accounts.size () * n_dates;
+    });
+
+    run ("balances-at-dates", scale, [&]() -> guint64 {
+        for (auto acc : accounts)
+        {
+            GList list = {acc, nullptr, nullptr};
+            g_free (xaccAccountListGetBalancesAtDates (&list, dates, n_dates,
+                                                      ACCOUNT_BALANCE_TOTAL,
+                                                      nullptr));
+        }
+        return accounts.size () * n_dates;
+    });
+
+    std::vector<CommodityPair> pairs;
+    gnc_pricedb_foreach_price (pdb, collect_price_pair, &pairs, FALSE);
+    auto n_lookups = CLAMP (scale / 10, 1000, 100000);
+    run ("price-lookup-nearest", scale, [&]() -> guint64 {
+        return lookup_prices (pdb, pairs, n_lookups, false);
+    });
+    run ("price-lookup-latest", scale, [&]() -> guint64 {
+        return lookup_prices (pdb, pairs, n_lookups, true);
+    });
+
+    run ("query-date", scale, [&]() -> guint64 {
+        for (guint i = 0; i + 1 < n_dates; ++i)
+            run_query (book, [&](QofQuery* q) {
+                xaccQueryAddDateMatchTT (q, TRUE, dates[i], TRUE,
+                                         dates[i + 1], QOF_QUERY_AND);
+            });
+        return n_dates - 1;
+    });
+    auto n_account_queries = MIN (accounts.size (), 100);
+    run ("query-account", scale, [&]() -> guint64 {
+        for (guint i = 0; i < n_account_queries; ++i)
+            run_query (book, [&](QofQuery* q) {
+                xaccQueryAddSingleAccountMatch (q, accounts[i],
+                                                QOF_QUERY_AND);
+            });
+        return n_account_queries;
+    });
+
+    save_and_load (session, "xml", dir, scale);
+    save_and_load (session, "sqlite3", dir, scale);
+
+    /* Last, as they change the book. */
+    run ("scrub-orphans", scale, [&]() -> guint64 {
+        xaccAccountTreeScrubOrphans (root, nullptr);
+        return 1;
+    });
+    run ("scrub-imbalance", scale, [&]() -> guint64 {
+        xaccAccountTreeScrubImbalance (root, nullptr);
+        return 1;
+    });
+    run ("scrub-lots", scale, [&]() -> guint64 {
+        xaccAccountTreeScrubLots (root);
+        return 1;
+    });
+
+    qof_session_destroy (session);
+}
+
+int
+main (int argc, char** argv)
+{
+    unsigned int seed = 20200101;
+    const char* dir_arg = nullptr;
+    std::vector<guint64> scales;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg (argv[i]);
+        if (arg == "-s" && i + 1 < argc)
+            seed = strtoul (argv[++i], nullptr, 10);
+        else if (arg == "-d" && i + 1 < argc)
+            dir_arg = argv[++i];
+        else if (auto scale = strtoull (argv[i], nullptr, 10))
+            scales.push_back (scale);
+        else
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [-s seed] [-d dir] [splits...]" << std::endl;
+            return 1;
+        }
+    }
+    if (scales.empty ())
+        scales = {10000, 100000};
+
+    auto dir = dir_arg ? g_strdup (dir_arg) :
+        g_dir_make_tmp ("bench-engine-XXXXXX", nullptr);
+    if (!dir)
+    {
+        std::cerr << "Can't create a temporary directory" << std::endl;
+        return 1;
+    }
+
+    gnc_engine_init (argc, argv);
+    xaccLogDisable ();
+
+    for (auto scale : scales)
+    {
+        srand (seed);
+        bench_scale (scale, dir);
+    }
+
+    if (!dir_arg)
+        g_rmdir (dir);
+    g_free (dir);
+    return 0;
+}
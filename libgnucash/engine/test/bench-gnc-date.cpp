@@ -0,0 +1,110 @@
+/********************************************************************\
+ * bench-gnc-date.cpp -- Microbenchmark of time64/calendar          *
+ *                       conversions                                *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/* Times the gnc-date.h conversions that date bucketing relies on against
+ * the GncDateTime path they used to take. Not run by "make check"; build
+ * the bench-gnc-date target and run it by hand:
+ *
+ *     bench-gnc-date [iterations]
+ */
+
+extern "C"
+{
+#include <config.h>
+#include <glib.h>
+#include "gnc-date.h"
+}
+#include "../gnc-datetime.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static std::vector<time64>
+make_times (size_t count)
+{
+    /* 1990-01-01 to 2030-01-01, where nearly all book data lives. */
+    constexpr time64 first = 631152000;
+    constexpr time64 last = 1893456000;
+    std::mt19937_64 rng (20200101);
+    std::uniform_int_distribution<time64> dist (first, last);
+    std::vector<time64> times (count);
+    for (auto& time : times)
+        time = dist (rng);
+    return times;
+}
+
+static void
+report (const char* name, const std::vector<time64>& times,
+        const std::function<int64_t(time64)>& func)
+{
+    int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now ();
+    for (auto time : times)
+        checksum += func (time);
+    auto elapsed = std::chrono::steady_clock::now () - start;
+    auto ns = std::chrono::duration<double, std::nano>(elapsed).count ();
+    std::cout << name << ": " << ns / times.size () << " ns/call"
+              << " (checksum " << checksum << ")" << std::endl;
+}
+
+int
+main (int argc, char** argv)
+{
+    size_t iterations = argc > 1 ? strtoul (argv[1], nullptr, 10) : 1000000;
+    auto times = make_times (iterations);
+
+    report ("GncDateTime to struct tm", times, [](time64 t) {
+        auto tm = static_cast<struct tm>(GncDateTime (t));
+        return static_cast<int64_t>(tm.tm_mday);
+    });
+    report ("gnc_localtime_r", times, [](time64 t) {
+        struct tm tm;
+        gnc_localtime_r (&t, &tm);
+        return static_cast<int64_t>(tm.tm_mday);
+    });
+    report ("GncDateTime from struct tm", times, [](time64 t) {
+        struct tm tm;
+        gnc_localtime_r (&t, &tm);
+        return static_cast<time64>(GncDateTime (tm));
+    });
+    report ("gnc_mktime", times, [](time64 t) {
+        struct tm tm;
+        gnc_localtime_r (&t, &tm);
+        return gnc_mktime (&tm);
+    });
+    report ("gnc_time64_get_day_start", times, [](time64 t) {
+        return gnc_time64_get_day_start (t);
+    });
+    report ("gnc_time64_get_day_end", times, [](time64 t) {
+        return gnc_time64_get_day_end (t);
+    });
+    report ("time64_to_gdate", times, [](time64 t) {
+        auto date = time64_to_gdate (t);
+        return static_cast<int64_t>(g_date_get_julian (&date));
+    });
+    return 0;
+}
@@ -466,6 +466,60 @@ TEST(gnc_datetime_functions, test_date)
     EXPECT_EQ(ymd.month, 11);
     EXPECT_EQ(ymd.day - (12 + atime.offset() / 3600) / 24, 13);
 }
+
+static void
+compare_fast_local_tm(time64 first, time64 last, time64 step)
+{
+    for (auto time = first; time < last; time += step)
+    {
+        struct tm fast, slow;
+        ASSERT_TRUE(gnc_datetime_local_tm(time, fast)) << time;
+        slow = static_cast<struct tm>(GncDateTime(time));
+        EXPECT_EQ(fast.tm_year, slow.tm_year) << time;
+        EXPECT_EQ(fast.tm_mon, slow.tm_mon) << time;
+        EXPECT_EQ(fast.tm_mday, slow.tm_mday) << time;
+        EXPECT_EQ(fast.tm_hour, slow.tm_hour) << time;
+        EXPECT_EQ(fast.tm_min, slow.tm_min) << time;
+        EXPECT_EQ(fast.tm_sec, slow.tm_sec) << time;
+        EXPECT_EQ(fast.tm_wday, slow.tm_wday) << time;
+        EXPECT_EQ(fast.tm_yday, slow.tm_yday) << time;
+        EXPECT_EQ(fast.tm_isdst, slow.tm_isdst) << time;
+
+        time64 back;
+        if (gnc_datetime_local_time64(slow, back))
+            EXPECT_EQ(static_cast<time64>(GncDateTime(slow)), back) << time;
+    }
+}
+
+TEST(gnc_datetime_functions, test_fast_local_tm)
+{
+#ifdef __MINGW32__
+    TimeZoneProvider tzp_lon{"GMT Standard Time"};
+    TimeZoneProvider tzp_syd{"AUS Eastern Standard Time"};
+    TimeZoneProvider tzp_la{"Pacific Standard Time"};
+#else
+    TimeZoneProvider tzp_lon("Europe/London");
+    TimeZoneProvider tzp_syd("Australia/Sydney");
+    TimeZoneProvider tzp_la("America/Los_Angeles");
+#endif
+    constexpr time64 start_2017 = 1483228800;
+    constexpr time64 start_2019 = 1546300800;
+    constexpr time64 start_1950 = -631152000;
+    constexpr time64 seventeen_minutes = 17 * 60;
+    for (auto tzp : {&tzp_lon, &tzp_syd, &tzp_la})
+    {
+        _set_tzp(*tzp);
+        compare_fast_local_tm(start_2017, start_2019, seventeen_minutes);
+        compare_fast_local_tm(start_1950, start_1950 + 86400 * 365,
+                              seventeen_minutes);
+        _reset_tzp();
+    }
+
+    struct tm tm;
+    EXPECT_FALSE(gnc_datetime_local_tm(MAXTIME, tm));
+    EXPECT_FALSE(gnc_datetime_local_tm(MINTIME, tm));
+}
+
 /* This test works only in the America/LosAngeles time zone and
  * there's no way at present to make it more flexible.
 TEST(gnc_datetime_functions, test_timezone_offset)
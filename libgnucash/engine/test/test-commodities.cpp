@@ -172,6 +172,27 @@ test_commodity(void)
                 do_test(
                     gnc_commodity_equiv(testcom, coms[j]),
                     "lookup commodity and test equiv");
+
+                testcom = gnc_commodity_table_find_full(
+                              tbl, gnc_commodity_get_namespace(coms[j]),
+                              gnc_commodity_get_printname(coms[j]));
+                do_test(
+                    testcom != NULL &&
+                    g_strcmp0(gnc_commodity_get_printname(testcom),
+                              gnc_commodity_get_printname(coms[j])) == 0,
+                    "find commodity by printname");
+
+                if (gnc_commodity_get_cusip(coms[j]) &&
+                    *gnc_commodity_get_cusip(coms[j]))
+                {
+                    testcom = gnc_commodity_table_lookup_by_cusip(
+                                  tbl, gnc_commodity_get_cusip(coms[j]));
+                    do_test(
+                        testcom != NULL &&
+                        g_strcmp0(gnc_commodity_get_cusip(testcom),
+                                  gnc_commodity_get_cusip(coms[j])) == 0,
+                        "lookup commodity by cusip");
+                }
             }
 
             do_test(
@@ -181,6 +202,39 @@ test_commodity(void)
         }
     }
 
+    {
+        gnc_commodity_table *tbl;
+        gnc_commodity *com;
+        QofBook *book;
+
+        book = qof_book_new ();
+        tbl = gnc_commodity_table_get_table (book);
+        com = gnc_commodity_new (book, "Foo Corp", "NASDAQ", "FOO",
+                                 "123456789", 1);
+        gnc_commodity_table_insert (tbl, com);
+
+        do_test (gnc_commodity_table_lookup_by_cusip (tbl, "123456789") == com,
+                 "lookup inserted commodity by cusip");
+        gnc_commodity_set_cusip (com, "987654321");
+        do_test (gnc_commodity_table_lookup_by_cusip (tbl, "123456789") == NULL,
+                 "old cusip no longer found");
+        do_test (gnc_commodity_table_lookup_by_cusip (tbl, "987654321") == com,
+                 "lookup commodity by new cusip");
+
+        gnc_commodity_set_fullname (com, "Bar Corp");
+        do_test (gnc_commodity_table_find_full (tbl, "NASDAQ",
+                                                "FOO (Foo Corp)") == NULL,
+                 "old printname no longer found");
+        do_test (gnc_commodity_table_find_full (tbl, "NASDAQ",
+                                                "FOO (Bar Corp)") == com,
+                 "find commodity by new printname");
+
+        gnc_commodity_table_remove (tbl, com);
+        do_test (gnc_commodity_table_lookup_by_cusip (tbl, "987654321") == NULL,
+                 "removed commodity not found by cusip");
+        gnc_commodity_destroy (com);
+        qof_book_destroy (book);
+    }
 }
 
 int
@@ -32,6 +32,8 @@ extern "C"
 #include "qof.h"
 #include "Account.h"
 #include "Scrub3.h"
+#include "cap-gains.h"
+#include "gnc-lot.h"
 #include "cashobjects.h"
 #include "test-stuff.h"
 #include "test-engine-stuff.h"
@@ -71,6 +73,79 @@ run_test (void)
 
 }
 
+/* Open a lot in acc with a transaction of amount posted on date,
+ * balanced against other. */
+static GNCLot *
+open_lot (Account *acc, Account *other, gnc_commodity *curr,
+          time64 date, gint64 amount)
+{
+    QofBook *book = gnc_account_get_book (acc);
+    Transaction *trans = xaccMallocTransaction (book);
+    Split *split = xaccMallocSplit (book);
+    Split *balance = xaccMallocSplit (book);
+    GNCLot *lot = gnc_lot_new (book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, curr);
+    xaccTransSetDatePostedSecsNormalized (trans, date);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetParent (balance, trans);
+    xaccSplitSetAccount (split, acc);
+    xaccSplitSetAccount (balance, other);
+    xaccSplitSetAmount (split, gnc_numeric_create (amount, 1));
+    xaccSplitSetValue (split, gnc_numeric_create (amount, 1));
+    xaccSplitSetAmount (balance, gnc_numeric_create (-amount, 1));
+    xaccSplitSetValue (balance, gnc_numeric_create (-amount, 1));
+    xaccTransCommitEdit (trans);
+
+    gnc_lot_add_split (lot, split);
+    return lot;
+}
+
+/* Lots opened on the same date are found in the order of the account's
+ * lot list, by both the earliest and the latest lookup. */
+static void
+run_same_date_test (void)
+{
+    QofBook *book = qof_book_new ();
+    Account *root = gnc_account_create_root (book);
+    Account *acc = xaccMallocAccount (book);
+    Account *other = xaccMallocAccount (book);
+    gnc_commodity *curr = gnc_commodity_new (book, "Gnu Rand", "CURRENCY",
+                                             "GNR", "", 100);
+    gnc_numeric sell = gnc_numeric_create (-1, 1);
+    time64 date = gnc_dmy2time64_neutral (15, 6, 2020);
+    GNCLot *first, *second, *later;
+    LotList *lots;
+
+    xaccAccountSetCommodity (acc, curr);
+    xaccAccountSetCommodity (other, curr);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, other);
+
+    first = open_lot (acc, other, curr, date, 10);
+    do_test (xaccAccountFindEarliestOpenLot (acc, sell, curr) == first,
+             "only lot is the earliest");
+
+    /* The index exists now; the next lots are added to it. */
+    second = open_lot (acc, other, curr, date, 10);
+    lots = xaccAccountGetLotList (acc);
+    do_test (lots->data == second, "new lot is first in the lot list");
+    g_list_free (lots);
+    do_test (xaccAccountFindEarliestOpenLot (acc, sell, curr) == second,
+             "earliest of two same-date lots is the first in the list");
+    do_test (xaccAccountFindLatestOpenLot (acc, sell, curr) == second,
+             "latest of two same-date lots is the first in the list");
+
+    later = open_lot (acc, other, curr, date + 86400, 10);
+    do_test (xaccAccountFindEarliestOpenLot (acc, sell, curr) == second,
+             "later lot doesn't change the earliest");
+    do_test (xaccAccountFindLatestOpenLot (acc, sell, curr) == later,
+             "later lot is the latest");
+
+    qof_book_destroy (book);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -96,6 +171,7 @@ main (int argc, char **argv)
     /* 'erase' the recurring tag line with dummy spaces. */
     fprintf(stdout, "Lots: Test series complete.         \n");
     fflush(stdout);
+    run_same_date_test ();
     print_test_results();
 
     qof_close();
@@ -664,6 +664,92 @@ check_add_subtract_overflow (void)
 
 /* ======================================================= */
 
+/* The 64-bit fast paths for operands whose denominators divide one
+ * another must give exactly what the general code gives. */
+static void
+check_fast_paths (void)
+{
+    gnc_numeric a = gnc_numeric_create (123, 100);
+    gnc_numeric b = gnc_numeric_create (-4567, 1000);
+    gnc_numeric big = gnc_numeric_create (INT64_MAX - 1, 100);
+    gnc_numeric result;
+
+    check_binary_op (gnc_numeric_create (-3337, 1000),
+                     gnc_numeric_add (a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD),
+                     a, b, "expected %s got %s = %s + %s for add LCD");
+    check_binary_op (gnc_numeric_create (-3337, 1000),
+                     gnc_numeric_add (a, b, 1000, GNC_HOW_RND_NEVER),
+                     a, b, "expected %s got %s = %s + %s for add 1000");
+    check_binary_op (gnc_numeric_create (5797, 1000),
+                     gnc_numeric_sub (a, b, GNC_DENOM_AUTO,
+                                      GNC_HOW_DENOM_EXACT),
+                     a, b, "expected %s got %s = %s - %s for sub exact");
+    check_binary_op (gnc_numeric_create (246, 100),
+                     gnc_numeric_add_fixed (a, a),
+                     a, a, "expected %s got %s = %s + %s for add fixed");
+    check_binary_op (gnc_numeric_create (0, 100),
+                     gnc_numeric_sub_fixed (a, a),
+                     a, a, "expected %s got %s = %s - %s for sub fixed");
+    check_binary_op (gnc_numeric_create (0, 1),
+                     gnc_numeric_sub (a, a, GNC_DENOM_AUTO,
+                                      GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND),
+                     a, a, "expected %s got %s = %s - %s for sub exact round");
+    check_binary_op (gnc_numeric_create (-561741, 100000),
+                     gnc_numeric_mul (a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT),
+                     a, b, "expected %s got %s = %s * %s for mul exact");
+    check_binary_op (gnc_numeric_create (-5617410, 1000000),
+                     gnc_numeric_mul (a, b, 1000000, GNC_HOW_RND_ROUND),
+                     a, b, "expected %s got %s = %s * %s for mul 1000000");
+    check_binary_op (gnc_numeric_create (-5617, 1000),
+                     gnc_numeric_mul (a, b, 1000, GNC_HOW_RND_ROUND),
+                     a, b, "expected %s got %s = %s * %s for mul rounded");
+
+    /* Overflowing 64 bits falls back to the 128-bit code rather than
+     * wrapping around. */
+    result = gnc_numeric_add_fixed (big, gnc_numeric_create (2, 100));
+    do_test (gnc_numeric_check (result) || gnc_numeric_positive_p (result),
+             "add overflowing 64 bits wrapped around");
+    result = gnc_numeric_mul (big, gnc_numeric_create (2, 1), 100,
+                              GNC_HOW_RND_NEVER);
+    do_test (gnc_numeric_check (result) || gnc_numeric_positive_p (result),
+             "mul overflowing 64 bits wrapped around");
+}
+
+/* ======================================================= */
+
+static void
+check_sum (void)
+{
+    gnc_numeric values[20];
+    gnc_numeric expected = gnc_numeric_zero ();
+    gnc_numeric result;
+    int i;
+
+    for (i = 0; i < 20; i++)
+    {
+        values[i] = gnc_numeric_create (get_random_gint64 () % 100000000,
+                                        i == 7 ? 1000 : 100);
+        expected = gnc_numeric_add (expected, values[i], GNC_DENOM_AUTO,
+                                    GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+    }
+    result = gnc_numeric_sum (values, 20, GNC_DENOM_AUTO,
+                              GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+    check_binary_op (expected, result, values[0], values[19],
+                     "expected %s got %s for the sum of %s ... %s");
+
+    result = gnc_numeric_sum (values, 0, 100, GNC_HOW_RND_ROUND);
+    do_test (gnc_numeric_eq (result, gnc_numeric_zero ()),
+             "empty sum isn't zero");
+
+    values[3] = gnc_numeric_error (GNC_ERROR_OVERFLOW);
+    result = gnc_numeric_sum (values, 20, GNC_DENOM_AUTO,
+                              GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+    do_test (gnc_numeric_check (result) == GNC_ERROR_ARG,
+             "sum with an invalid value didn't fail");
+}
+
+/* ======================================================= */
+
 
 static void
 check_mult_div (void)
@@ -898,6 +984,8 @@ run_test (void)
     check_neg();
     check_add_subtract();
     check_add_subtract_overflow ();
+    check_fast_paths ();
+    check_sum ();
     check_mult_div ();
 }
 
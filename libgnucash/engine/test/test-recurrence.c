@@ -398,6 +398,52 @@ static void test_some()
     test_specific(PERIOD_DAY, 7,    4, 1, 2000,    4, 8, 2000,  4, 15, 2000);
 }
 
+/* recurrenceNthInstance must agree with stepping through
+   recurrenceNextInstance from the start date. */
+static void test_nth_instance()
+{
+    Recurrence r;
+    GDate d_start, d_step, d_ref, d_nth;
+    PeriodType pt;
+    WeekendAdjust wadj;
+    guint16 mult;
+    gint32 j;
+    guint n;
+
+    for (pt = PERIOD_ONCE; pt < NUM_PERIOD_TYPES; pt++)
+    {
+        for (wadj = WEEKEND_ADJ_NONE; wadj < NUM_WEEKEND_ADJS; wadj++)
+        {
+            for (j = JULIAN_START; j < JULIAN_START + NUM_DATES_TO_TEST; j += 3)
+            {
+                g_date_set_julian(&d_start, j);
+                for (mult = 1; mult < 4; mult++)
+                {
+                    recurrenceSet(&r, mult, pt, &d_start, wadj);
+                    d_step = d_ref = recurrenceGetDate(&r);
+                    for (n = 0; n < 30; n++)
+                    {
+                        if (n > 0)
+                        {
+                            recurrenceNextInstance(&r, &d_ref, &d_step);
+                            if (!g_date_valid(&d_step))
+                                break;
+                            d_ref = d_step;
+                        }
+                        recurrenceNthInstance(&r, n, &d_nth);
+                        if (!test_equal(&d_nth, &d_step))
+                        {
+                            printf("pt = %d; mult = %d; wadj = %d; n = %u\n",
+                                   pt, mult, wadj, n);
+                            return;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 static void test_use()
 {
     Recurrence *r;
@@ -416,6 +462,8 @@ static void test_main()
 
     test_some();
 
+    test_nth_instance();
+
     test_all();
 
     qof_book_destroy (book);
@@ -1552,10 +1552,49 @@ test_gnc_account_append_remove_child (Fixture *fixture, gconstpointer pData)
  * gnc_account_is_root
  * gnc_account_get_children
  * gnc_account_get_children_sorted
- * gnc_account_n_children
- * gnc_account_child_index
- * gnc_account_nth_child
  */
+/* gnc_account_n_children
+gint
+gnc_account_n_children (const Account *account)
+gnc_account_child_index
+gint
+gnc_account_child_index (const Account *parent, const Account *child)
+gnc_account_nth_child
+Account *
+gnc_account_nth_child (const Account *parent, gint num)
+*/
+static void
+test_gnc_account_nth_child (Fixture *fixture, gconstpointer pData)
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    GList *children = gnc_account_get_children (root);
+    gint num = g_list_length (children), i = 0;
+    Account *first = static_cast<Account*>(children->data);
+
+    g_assert_cmpint (gnc_account_n_children (root), ==, num);
+    for (GList *node = children; node; node = g_list_next (node), ++i)
+    {
+        auto child = static_cast<Account*>(node->data);
+        g_assert (gnc_account_nth_child (root, i) == child);
+        g_assert_cmpint (gnc_account_child_index (root, child), ==, i);
+    }
+    g_assert (gnc_account_nth_child (root, num) == NULL);
+    g_assert (gnc_account_nth_child (root, -1) == NULL);
+    g_assert_cmpint (gnc_account_child_index (fixture->acct, first), ==, -1);
+
+    /* Moving the first child to the end shifts all others down */
+    gnc_account_remove_child (root, first);
+    g_assert_cmpint (gnc_account_n_children (root), ==, num - 1);
+    g_assert_cmpint (gnc_account_child_index (root, first), ==, -1);
+    if (num > 1)
+        g_assert (gnc_account_nth_child (root, 0) ==
+                  static_cast<Account*>(children->next->data));
+    gnc_account_append_child (root, first);
+    g_assert_cmpint (gnc_account_n_children (root), ==, num);
+    g_assert_cmpint (gnc_account_child_index (root, first), ==, num - 1);
+    g_assert (gnc_account_nth_child (root, num - 1) == first);
+    g_list_free (children);
+}
 /* gnc_account_n_descendants
 gint
 gnc_account_n_descendants (const Account *account)// C: 12 in 6 */
@@ -1742,6 +1781,65 @@ test_gnc_account_lookup_by_full_name (Fixture *fixture, gconstpointer pData)
     target = gnc_account_lookup_by_full_name (root, names3);
     g_assert (target == NULL);
     g_free (code);
+
+    /* Renaming an account must be seen by the next lookup. */
+    target = gnc_account_lookup_by_full_name (root, names2);
+    xaccAccountSetName (gnc_account_get_parent (target), "nontaxable");
+    g_assert (gnc_account_lookup_by_full_name (root, names2) == NULL);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:nontaxable:int") == target);
+}
+
+/* The index is kept up to date as accounts are added and moved, the way
+ * the importers interleave lookups with appends. */
+static void
+test_gnc_account_lookup_by_full_name_append (Fixture *fixture,
+                                             gconstpointer pData)
+{
+    auto root = gnc_account_get_root (fixture->acct);
+    auto book = gnc_account_get_book (root);
+    auto income = gnc_account_lookup_by_full_name (root, "income");
+    auto exempt = gnc_account_lookup_by_full_name (root, "income:exempt");
+    g_assert (income != NULL);
+    g_assert (exempt != NULL);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        auto name = g_strdup_printf ("new%d", i);
+        auto full_name = g_strdup_printf ("income:exempt:new%d", i);
+        g_assert (gnc_account_lookup_by_full_name (root, full_name) == NULL);
+        auto acct = xaccMallocAccount (book);
+        xaccAccountSetName (acct, name);
+        gnc_account_append_child (exempt, acct);
+        g_assert (gnc_account_lookup_by_full_name (root, full_name) == acct);
+        g_free (full_name);
+        g_free (name);
+    }
+
+    /* Moving a subtree re-keys it and its descendants. */
+    auto sub = xaccMallocAccount (book);
+    xaccAccountSetName (sub, "sub");
+    gnc_account_append_child (gnc_account_lookup_by_full_name (root,
+                                                               "income:exempt:new3"),
+                              sub);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:exempt:new3:sub") == sub);
+    auto new3 = gnc_account_get_parent (sub);
+    gnc_account_append_child (income, new3);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:exempt:new3") == NULL);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:exempt:new3:sub") == NULL);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:new3") == new3);
+    g_assert (gnc_account_lookup_by_full_name (root, "income:new3:sub") == sub);
+
+    /* Of the accounts sharing a full name the first in the tree wins,
+     * also after the tree is reordered. */
+    auto baz = gnc_account_lookup_by_full_name (root, "assets:broker:stocks:baz");
+    g_assert (baz != NULL);
+    g_assert_cmpint (xaccAccountGetType (baz), == , ACCT_TYPE_STOCK);
+    auto stocks = gnc_account_get_parent (baz);
+    gnc_account_remove_child (stocks, baz);
+    gnc_account_append_child (stocks, baz);
+    auto next = gnc_account_lookup_by_full_name (root, "assets:broker:stocks:baz");
+    g_assert (next != NULL && next != baz);
+    g_assert_cmpint (xaccAccountGetType (next), == , ACCT_TYPE_MUTUAL);
 }
 
 static void
@@ -1868,6 +1966,16 @@ test_gnc_account_get_full_name (Fixture *fixture, gconstpointer pData)
     g_assert_cmpstr (result, == , "foo:baz:waldo");
     g_free (result);
 
+    /* The cached full name follows renames and separator changes. */
+    xaccAccountSetName (gnc_account_get_parent (fixture->acct), "qux");
+    result = gnc_account_get_full_name (fixture->acct);
+    g_assert_cmpstr (result, == , "foo:qux:waldo");
+    g_free (result);
+    gnc_set_account_separator ("/");
+    result = gnc_account_get_full_name (fixture->acct);
+    g_assert_cmpstr (result, == , "foo/qux/waldo");
+    g_free (result);
+    gnc_set_account_separator (":");
 }
 
 /* DxaccAccountGetCurrency
@@ -1932,6 +2040,38 @@ test_xaccAccountGetBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+/* xaccAccountListGetBalancesAtDates
+gnc_numeric *
+xaccAccountListGetBalancesAtDates (AccountList *accounts, const time64 *dates,
+                                   guint n_dates, GNCAccountBalanceKind kind,
+                                   gnc_commodity *report_commodity)// C: 1 SCM: 1*/
+static void
+test_xaccAccountListGetBalancesAtDates (Fixture *fixture, gconstpointer pData)
+{
+    time64 now = gnc_time (NULL);
+    time64 dates[] = { now - 24 * 3600 * 3, now + 24 * 3600 * 365 };
+    GList *accounts = g_list_prepend (NULL, fixture->acct);
+    gnc_numeric *balances;
+
+    xaccAccountRecomputeBalance (fixture->acct);
+    balances = xaccAccountListGetBalancesAtDates (accounts, dates, 2,
+                                                  ACCOUNT_BALANCE_TOTAL,
+                                                  NULL);
+    g_assert (gnc_numeric_equal (balances[0],
+                                 xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                                dates[0])));
+    g_assert (gnc_numeric_equal (balances[1],
+                                 xaccAccountGetBalance (fixture->acct)));
+    g_free (balances);
+
+    balances = xaccAccountListGetBalancesAtDates (accounts, dates, 2,
+                                                  ACCOUNT_BALANCE_RECONCILED,
+                                                  NULL);
+    g_assert (gnc_numeric_equal (balances[1],
+                                 xaccAccountGetReconciledBalance (fixture->acct)));
+    g_free (balances);
+    g_list_free (accounts);
+}
 /* xaccAccountGetPresentBalance
 gnc_numeric
 xaccAccountGetPresentBalance (const Account *acc)// C: 4 in 2 */
@@ -2563,6 +2703,7 @@ test_suite_account (void)
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
     GNC_TEST_ADD (suitename, "qofAccountSetParent", Fixture, &some_data, setup, test_qofAccountSetParent,  teardown );
     GNC_TEST_ADD (suitename, "gnc account append/remove child", Fixture, NULL, setup, test_gnc_account_append_remove_child,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account nth child", Fixture, &complex, setup, test_gnc_account_nth_child,  teardown );
     GNC_TEST_ADD (suitename, "gnc account n descendants", Fixture, &some_data, setup, test_gnc_account_n_descendants,  teardown );
     GNC_TEST_ADD (suitename, "gnc account get current depth", Fixture, &some_data, setup, test_gnc_account_get_current_depth,  teardown );
     GNC_TEST_ADD (suitename, "gnc account get tree depth", Fixture, &complex, setup, test_gnc_account_get_tree_depth,  teardown );
@@ -2572,12 +2713,14 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account lookup by code", Fixture, &complex, setup, test_gnc_account_lookup_by_code,  teardown );
     GNC_TEST_ADD (suitename, "gnc account lookup by full name helper", Fixture, &complex, setup, test_gnc_account_lookup_by_full_name_helper,  teardown );
     GNC_TEST_ADD (suitename, "gnc account lookup by full name", Fixture, &complex, setup, test_gnc_account_lookup_by_full_name,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account lookup by full name append", Fixture, &complex, setup, test_gnc_account_lookup_by_full_name_append,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach child", Fixture, &complex, setup, test_gnc_account_foreach_child,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach descendant", Fixture, &complex, setup, test_gnc_account_foreach_descendant,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach descendant until", Fixture, &complex, setup, test_gnc_account_foreach_descendant_until,  teardown );
     GNC_TEST_ADD (suitename, "gnc account get full name", Fixture, &good_data, setup, test_gnc_account_get_full_name,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountListGetBalancesAtDates", Fixture, &some_data, setup, test_xaccAccountListGetBalancesAtDates,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
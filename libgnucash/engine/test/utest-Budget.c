@@ -26,6 +26,9 @@
 #include <gnc-event.h>
 /* Add specific headers for this class */
 #include "gnc-budget.h"
+#include "Account.h"
+#include "Split.h"
+#include "Transaction.h"
 
 static const gchar *suitename = "/engine/Budget";
 void test_suite_budget(void);
@@ -156,6 +159,82 @@ test_gnc_set_budget_account_period_value()
     qof_book_destroy(book);
 }
 
+static void
+add_budget_test_txn (QofBook *book, gnc_commodity *curr, Account *acc,
+                     Account *other, time64 date, gint64 amount)
+{
+    Transaction *txn = xaccMallocTransaction (book);
+    Split *split = xaccMallocSplit (book);
+    Split *other_split = xaccMallocSplit (book);
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetCurrency (txn, curr);
+    xaccTransSetDatePostedSecsNormalized (txn, date);
+    xaccSplitSetParent (split, txn);
+    xaccSplitSetAccount (split, acc);
+    xaccSplitSetAmount (split, gnc_numeric_create (amount, 1));
+    xaccSplitSetValue (split, gnc_numeric_create (amount, 1));
+    xaccSplitSetParent (other_split, txn);
+    xaccSplitSetAccount (other_split, other);
+    xaccSplitSetAmount (other_split, gnc_numeric_create (-amount, 1));
+    xaccSplitSetValue (other_split, gnc_numeric_create (-amount, 1));
+    xaccTransCommitEdit (txn);
+}
+
+static void
+test_gnc_budget_account_period_actual_value()
+{
+    QofBook *book = qof_book_new();
+    GncBudget* budget = gnc_budget_new(book);
+    gnc_commodity *curr = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD", "0", 100);
+    Account *root = gnc_account_create_root (book);
+    Account *parent = xaccMallocAccount (book);
+    Account *child = xaccMallocAccount (book);
+    Account *other = xaccMallocAccount (book);
+    Recurrence r;
+    GDate start_date;
+    time64 feb;
+
+    xaccAccountSetCommodity (parent, curr);
+    xaccAccountSetCommodity (child, curr);
+    xaccAccountSetCommodity (other, curr);
+    gnc_account_append_child (root, parent);
+    gnc_account_append_child (parent, child);
+    gnc_account_append_child (root, other);
+
+    g_date_set_dmy(&start_date, 1, G_DATE_JANUARY, 2012);
+    recurrenceSet(&r, 1, PERIOD_MONTH, &start_date, WEEKEND_ADJ_NONE);
+    gnc_budget_set_recurrence(budget, &r);
+    feb = gnc_dmy2time64_neutral (15, 2, 2012);
+
+    add_budget_test_txn (book, curr, child, other, feb, 50);
+    g_assert (gnc_numeric_equal (gnc_budget_get_account_period_actual_value (budget, child, 1),
+                                 gnc_numeric_create (50, 1)));
+    g_assert (gnc_numeric_zero_p (gnc_budget_get_account_period_actual_value (budget, child, 0)));
+    g_assert (gnc_numeric_equal (gnc_budget_get_account_period_actual_value (budget, parent, 1),
+                                 gnc_numeric_create (50, 1)));
+
+    /* The cached rows have to follow changes to the splits. */
+    add_budget_test_txn (book, curr, child, other, feb, 25);
+    g_assert (gnc_numeric_equal (gnc_budget_get_account_period_actual_value (budget, child, 1),
+                                 gnc_numeric_create (75, 1)));
+    g_assert (gnc_numeric_equal (gnc_budget_get_account_period_actual_value (budget, parent, 1),
+                                 gnc_numeric_create (75, 1)));
+    g_assert (gnc_numeric_equal (gnc_budget_get_account_period_actual_value (budget, other, 1),
+                                 gnc_numeric_create (-75, 1)));
+
+    /* And so do the budget values. */
+    g_assert (!gnc_budget_is_account_period_value_set (budget, child, 1));
+    gnc_budget_set_account_period_value (budget, child, 1, gnc_numeric_create (60, 1));
+    g_assert (gnc_numeric_equal (gnc_budget_get_account_period_value (budget, child, 1),
+                                 gnc_numeric_create (60, 1)));
+    gnc_budget_unset_account_period_value (budget, child, 1);
+    g_assert (!gnc_budget_is_account_period_value_set (budget, child, 1));
+
+    gnc_budget_destroy(budget);
+    qof_book_destroy(book);
+}
+
 void
 test_suite_budget(void)
 {
@@ -165,5 +244,6 @@ test_suite_budget(void)
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_num_periods()", test_gnc_set_budget_num_periods);
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_recurrence()", test_gnc_set_budget_recurrence);
     GNC_TEST_ADD_FUNC(suitename, "gnc_budget_set_account_period_value()", test_gnc_set_budget_account_period_value);
+    GNC_TEST_ADD_FUNC(suitename, "gnc_budget_get_account_period_actual_value()", test_gnc_budget_account_period_actual_value);
 
 }
@@ -107,7 +107,7 @@ teardown( Fixture *fixture, gconstpointer pData )
 };
 
 static void
-setup_with_invoice( Fixture *fixture, gconstpointer pData )
+setup_invoice( Fixture *fixture, gconstpointer pData, gboolean with_price )
 {
     const InvoiceData *data = (InvoiceData*) pData;
 
@@ -131,17 +131,35 @@ setup_with_invoice( Fixture *fixture, gconstpointer pData )
     if (data->is_cust_doc)
     {
         gncEntrySetInvAccount(entry, fixture->account);
+        if (with_price)
+            gncEntrySetInvPrice(entry, data->price);
         gncInvoiceAddEntry (fixture->invoice, entry);
     }
     else
     {
         gncEntrySetBillAccount(entry, fixture->account);
+        if (with_price)
+            gncEntrySetBillPrice(entry, data->price);
         gncBillAddEntry(fixture->invoice, entry);
     }
 
     fixture->trans = gncInvoicePostToAccount(fixture->invoice, fixture->account2, ts1, ts2, "memo", TRUE, FALSE);
 }
 
+static void
+setup_with_invoice( Fixture *fixture, gconstpointer pData )
+{
+    setup_invoice(fixture, pData, FALSE);
+}
+
+/* The owner lot tests need an invoice with a balance, or its lot
+ * would be closed. */
+static void
+setup_with_priced_invoice( Fixture *fixture, gconstpointer pData )
+{
+    setup_invoice(fixture, pData, TRUE);
+}
+
 static void
 teardown_with_invoice( Fixture *fixture, gconstpointer pData )
 {
@@ -202,6 +220,40 @@ test_invoice_posted_trans ( Fixture *fixture, gconstpointer pData )
     }
 }
 
+static void
+test_invoice_owner_lots ( Fixture *fixture, gconstpointer pData )
+{
+    const InvoiceData *data = (InvoiceData*) pData;
+    GNCLot *lot = gncInvoiceGetPostedLot(fixture->invoice);
+    GList *lots;
+
+    /* Only lots of accounts of the owner's AR/AP type and in the
+     * owner's currency count towards the balance. */
+    xaccAccountSetType(fixture->account2, data->is_cust_doc ? ACCT_TYPE_RECEIVABLE : ACCT_TYPE_PAYABLE);
+    if (data->is_cust_doc)
+        gncCustomerSetCurrency(fixture->customer, fixture->commodity);
+    else
+        gncVendorSetCurrency(fixture->vendor, fixture->commodity);
+
+    lots = gncOwnerGetOpenLots(&fixture->owner);
+    g_assert_cmpint (g_list_length (lots), ==, 1);
+    g_assert (lots->data == lot);
+    g_list_free (lots);
+
+    lots = gncOwnerFindOpenLots(&fixture->owner, fixture->account2, NULL, NULL, NULL);
+    g_assert_cmpint (g_list_length (lots), ==, 1);
+    g_list_free (lots);
+    g_assert (gncOwnerFindOpenLots(&fixture->owner, fixture->account, NULL, NULL, NULL) == NULL);
+
+    g_assert (!gnc_numeric_zero_p (gnc_lot_get_balance(lot)));
+    g_assert (gnc_numeric_equal (gncOwnerGetBalanceInCurrency(&fixture->owner, NULL),
+                                 gnc_lot_get_balance(lot)));
+
+    /* Unposting destroys the lot, which must leave the index. */
+    gncInvoiceUnpost(fixture->invoice, TRUE);
+    g_assert (gncOwnerGetOpenLots(&fixture->owner) == NULL);
+}
+
 void
 test_suite_gncInvoice ( void )
 {
@@ -215,4 +267,5 @@ test_suite_gncInvoice ( void )
     GNC_TEST_ADD( suitename, "post trans - customer creditnote", Fixture, &pData, setup_with_invoice, test_invoice_posted_trans, teardown_with_invoice );
     pData.is_cn = FALSE;   // Customer invoice
     GNC_TEST_ADD( suitename, "post trans - customer invoice", Fixture, &pData, setup_with_invoice, test_invoice_posted_trans, teardown_with_invoice );
+    GNC_TEST_ADD( suitename, "owner lots - customer invoice", Fixture, &pData, setup_with_priced_invoice, test_invoice_owner_lots, teardown_with_invoice );
 }